@@ -9,13 +9,35 @@
 #define APP_H_
 
 #include "std_types.h"
+#include "frame.h"
 
 
 /*******************************************************************************
  *                      Definitions                                            *
  *******************************************************************************/
-#define  EEPROM_PASSWORD_LOCATION   0X0311
+/* longest password that can be stored */
+#define  PASSWORD_MAX_LENGTH        9
 
+/* door cycle: opening, held open, closing (software timers, in ms) */
+#define  APP_DOOR_MOVE_MS           (15000UL)
+#define  APP_DOOR_HOLD_MS           (3000UL)
+
+/* the buzzer keeps ringing this long once the system is locked */
+#define  APP_LOCKOUT_MS             (60000UL)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* stage of the door cycle started by openGate, as reported to HMI_ECU */
+typedef enum
+{
+	DOOR_CLOSED = FRAME_DOOR_CLOSED,
+	DOOR_OPENING = FRAME_DOOR_OPENING,
+	DOOR_HOLDING = FRAME_DOOR_HOLDING,
+	DOOR_CLOSING = FRAME_DOOR_CLOSING
+}APP_DoorStateType;
 
 
 /*******************************************************************************
@@ -27,40 +49,189 @@
  * Function Name: setPassword
  * Description  : This function is responsible for setting and updating
  *                the password of the system
+ * INPUTS       : request (frame holding the new password as payload)
+ * RETURNS      : uint8 (FRAME_RESULT_xxx sent to HMI_ECU)
+ **************************************************************************/
+uint8 setPassword(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: loadCredential
+ * Description  : Read the credential record from the store, if there is a
+ *                valid one the system is provisioned
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void setPassword(void);
+void loadCredential(void);
+
+
+/**************************************************************************
+ * Function Name: sendProvisioned
+ * Description  : Tell HMI_ECU if a password is already set, or that the
+ *                storage could not be loaded at startup
+ * INPUTS       : request (the provisioning query)
+ * RETURNS      : void
+ **************************************************************************/
+void sendProvisioned(const FRAME_Type *request);
 
 
 /**************************************************************************
  * Function Name: verifyPassword
  * Description  : The function is to check if the passed two passwords are identical
- * INPUTS       : void
+ * INPUTS       : request (frame holding the user entered password as payload)
+ * RETURNS      : void
+ **************************************************************************/
+void verifyPassword(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: getStorageResult
+ * Description  : Turn a storage status into the result byte of a response
+ * INPUTS       : status (SUCCESS, a refused request or an EEPROM failure)
+ * RETURNS      : uint8 (FRAME_RESULT_xxx)
+ **************************************************************************/
+uint8 getStorageResult(uint8 status);
+
+
+/**************************************************************************
+ * Function Name: isAdminCommand
+ * Description  : Tell if a request is served only after the password of an admin
+ * INPUTS       : opcode (FRAME_OP_xxx)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean isAdminCommand(uint8 opcode);
+
+
+/**************************************************************************
+ * Function Name: serveAdmin
+ * Description  : Serve an admin command, only after the password of an admin
+ *                (the first password is set without one). Setting the
+ *                password, adding or revoking a user ends the admin session,
+ *                the list and the audit dump go on for their next pages
+ * INPUTS       : request (the admin command)
  * RETURNS      : void
  **************************************************************************/
-void verifyPassword(void);
+void serveAdmin(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: addUser
+ * Description  : Admin command, add a user to the user table
+ * INPUTS       : request (frame holding the user flags then the PIN)
+ * RETURNS      : void
+ **************************************************************************/
+void addUser(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: revokeUser
+ * Description  : Admin command, remove a user from the user table
+ * INPUTS       : request (frame holding the user ID)
+ * RETURNS      : void
+ **************************************************************************/
+void revokeUser(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: listUsers
+ * Description  : Admin command, send the active users starting at an ID,
+ *                as many as fit in one response
+ * INPUTS       : request (frame holding the first user ID)
+ * RETURNS      : void
+ **************************************************************************/
+void listUsers(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: sendAudit
+ * Description  : Dump of the audit log, send the records of the events from
+ *                a SEQ on, as many as fit in one response
+ * INPUTS       : request (frame holding the first SEQ, none for the oldest event)
+ * RETURNS      : void
+ **************************************************************************/
+void sendAudit(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: setBaudRate
+ * Description  : Handle the link speed handshake, choose the fastest profile
+ *                supported by both ECUs, reply with it then switch to it
+ * INPUTS       : request (frame holding the HMI_ECU supported profiles bitmask)
+ * RETURNS      : void
+ **************************************************************************/
+void setBaudRate(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: sendStats
+ * Description  : Diagnostics command, send the link statistics of this ECU
+ * INPUTS       : request (the diagnostics request)
+ * RETURNS      : void
+ **************************************************************************/
+void sendStats(const FRAME_Type *request);
 
 
 /**************************************************************************
  * Function Name: openGate
- * Description  : This function is responsible to open the door
+ * Description  : Start the door cycle, it goes on in the background (door
+ *                timer) so requests are still served while the door moves
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void openGate(void);
 
 
+/**************************************************************************
+ * Function Name: stepDoor
+ * Description  : Callback of the door timer, move the door to the next
+ *                stage of its cycle
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void stepDoor(void);
+
+
+/**************************************************************************
+ * Function Name: sendDoorState
+ * Description  : Status poll, send the stage of the door cycle and the
+ *                seconds left before the next one
+ * INPUTS       : request (the status request)
+ * RETURNS      : void
+ **************************************************************************/
+void sendDoorState(const FRAME_Type *request);
+
+
+/**************************************************************************
+ * Function Name: abortDoor
+ * Description  : Stop the door cycle, an opening door closes back for as
+ *                long as it has been opening, an open door closes at once
+ * INPUTS       : request (the abort request)
+ * RETURNS      : void
+ **************************************************************************/
+void abortDoor(const FRAME_Type *request);
+
+
 /**************************************************************************
  * Function Name: lockSystem
  * Description  : This function is responsible for locking the system
- *                In case of password entered is wrong for 3 times
+ *                In case of password entered is wrong for 3 times,
+ *                the buzzer timer turns the buzzer off
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void lockSystem(void);
 
 
+/**************************************************************************
+ * Function Name: flushAudit
+ * Description  : Callback of the audit timer, write the events left in SRAM
+ *                once the link has been idle for AUDIT_FLUSH_MS
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void flushAudit(void);
+
+
 /**************************************************************************
  * Function Name: isPassMatched
  * Description  : This function is to compare user entered password && system password
@@ -69,55 +240,66 @@ void lockSystem(void);
  * 			      1 ==> Passwords match
  * 			      0 ==> Passwords do not match
  **************************************************************************/
-uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size);
+uint8 isPassMatched(const uint8 * pass1, const uint8 * pass2, uint8 size);
 
 
 
 /**************************************************************************
- * Function Name: TIMER1_callback_function
- * Description  : The required function to be executed when timer interrupt
- *                is fired, "increments ticks variable"
+ * Function Name: APP_init
+ * Description  : This function is responsible for initializing the peripherals used
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_callback_function(void);
-
+void APP_init(void);
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_15sec
- * Description  : This function is to generate 15 seconds delay using timer1.
+ * Function Name: APP_start
+ * Description  : Start serving the requests of HMI_ECU, every received byte
+ *                posts the receive task, then SCHEDULER_run takes over
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_15sec(void);
+void APP_start(void);
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_3sec
- * Description  : This function is to generate 3 seconds delay using timer1.
+ * Function Name: APP_onReceive
+ * Description  : UART RX handler (ISR context, see isr_hooks.h), post the
+ *                receive task
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_3sec(void);
-
+void APP_onReceive(void);
 
 
 /**************************************************************************
- * Function Name: APP_init
- * Description  : This function is responsible for initializing the peripherals used
+ * Function Name: APP_receive
+ * Description  : Receive task, serve the next complete request (one per
+ *                run, so the timers are served between two requests)
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void APP_init(void);
+void APP_receive(void);
 
 
 /**************************************************************************
- * Function Name: APP_start
- * Description  : This function is responsible for Running the system as required
- * INPUTS       : void
+ * Function Name: APP_sendResponse
+ * Description  : Send the response frame of a request to HMI_ECU
+ * INPUTS       : request (the request being answered), result (FRAME_RESULT_xxx)
  * RETURNS      : void
  **************************************************************************/
-void APP_start(void);
+void APP_sendResponse(const FRAME_Type *request, uint8 result);
+
+
+/**************************************************************************
+ * Function Name: APP_sendResponseData
+ * Description  : Send the response frame of a request to HMI_ECU with data
+ *                following the result byte
+ * INPUTS       : request (the request being answered), result (FRAME_RESULT_xxx),
+ *                data && length of the data (at most FRAME_MAX_PAYLOAD - 1)
+ * RETURNS      : void
+ **************************************************************************/
+void APP_sendResponseData(const FRAME_Type *request, uint8 result, const uint8 *data, uint8 length);
 
 #endif /* APP_H_ */
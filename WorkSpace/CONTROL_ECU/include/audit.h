@@ -0,0 +1,148 @@
+/*===========================================================================================
+ * Filename   : audit.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the audit event log ring in the external EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef AUDIT_H_
+#define AUDIT_H_
+
+#include "std_types.h"
+#include "layout.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the log is in the AUDIT region of the layout manifest */
+#define AUDIT_SIZE            LAYOUT_SIZE(AUDIT)
+#define AUDIT_PAGE_SIZE       LAYOUT_PAGE_SIZE(AUDIT)
+
+/* The log is a ring of blocks, each block is whole EEPROM pages:
+ * | SEQ_LOW | SEQ_HIGH | TIME (3 bytes) | records .. 0xFF padding | USED | CRC_LOW | CRC_HIGH |
+ * SEQ is the number of the first event of the block, the next ones follow.
+ * TIME is in seconds since the last reset, when the block was opened. A reset
+ * does not open a new block, the BOOT event goes on in the open one and gives
+ * the time again (its DELTA is the time since the reset, not since the record before).
+ * USED is the offset of the padding, CRC-16 is calculated over the header, the
+ * records and USED. Both are written when the block is full (sealed).
+ *
+ * A record is one byte, then only the fields it can not take from the record before:
+ * | EVENT (3 bits) | NEW_USER (1 bit) | NEW_RESULT (1 bit) | DELTA (3 bits) | [USER_ID] | [RESULT] | [DELTA varint] |
+ * NEW_USER   : USER_ID follows, else it is AUDIT_NO_USER for the events not
+ *              tied to a user (BOOT, ACCESS_DENIED, LOCKOUT) and the one of the
+ *              last event tied to a user for the others (AUDIT_NO_USER at the
+ *              start of a block)
+ * NEW_RESULT : RESULT follows, else it is the usual one of the event
+ *              (FRAME_RESULT_FAIL for ACCESS_DENIED, FRAME_RESULT_SUCCESS for the others)
+ * DELTA      : 0..5 seconds since the previous record (or TIME), 6 when the
+ *              delta follows, 7 bits per byte, low bits first, bit 7 set when
+ *              more bytes follow
+ * DELTA 7 is never written, so an erased 0xFF byte ends the records.
+ * A typical event takes 1 to 4 bytes instead of 8 for a fixed record, about 4.2
+ * times as many events fit in the log (door access with a reset now and then).
+ */
+#if (AUDIT_PAGE_SIZE >= 64)
+#define AUDIT_BLOCK_SIZE      (AUDIT_PAGE_SIZE)
+#else
+#define AUDIT_BLOCK_SIZE      (64U)
+#endif
+#define AUDIT_BLOCKS          (AUDIT_SIZE / AUDIT_BLOCK_SIZE)
+
+/* size of a record given by AUDIT_read, with every field:
+ * | SEQ_LOW | SEQ_HIGH | TIME (3 bytes, little endian) | EVENT | USER_ID | RESULT | */
+#define AUDIT_RECORD_SIZE     (8U)
+
+/* the encoding keeps 3 bits for EVENT */
+#define AUDIT_MAX_EVENT       (7U)
+
+/* records are kept in SRAM till their EEPROM page is full, so a burst of
+ * events costs one write cycle per page instead of one per event.
+ * Records left in SRAM are written anyway after this idle time */
+#define AUDIT_FLUSH_MS        (2000U)
+
+/* USER_ID of an event that is not tied to a user */
+#define AUDIT_NO_USER         (0xFFU)
+
+#if ((AUDIT_SIZE % AUDIT_BLOCK_SIZE) != 0) || ((AUDIT_BLOCK_SIZE % AUDIT_PAGE_SIZE) != 0) || (AUDIT_BLOCK_SIZE > 255)
+#error "the log must be made of whole blocks, each of whole EEPROM pages"
+#endif
+
+#if (AUDIT_BLOCKS < 2)
+#error "the log needs at least 2 blocks, one is reused while the others are kept"
+#endif
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: AUDIT_init
+ * Description  : Read the block headers to find the newest block, the next
+ *                events go on in it if a reset left it open
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_init(void);
+
+
+/**************************************************************************
+ * Function Name: AUDIT_log
+ * Description  : Encode an event in the open block in SRAM, every page of
+ *                the block is written once it is full, the block is sealed
+ *                when the next event does not fit
+ * INPUTS       : event (FRAME_EVENT_xxx, at most AUDIT_MAX_EVENT),
+ *                user_id (AUDIT_NO_USER if none), result (FRAME_RESULT_xxx)
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE for a bad event,
+ *                or the EEPROM status, the records that could not be
+ *                written stay in SRAM and new events are dropped while the
+ *                block can not be sealed)
+ **************************************************************************/
+uint8 AUDIT_log(uint8 event, uint8 user_id, uint8 result);
+
+
+/**************************************************************************
+ * Function Name: AUDIT_flush
+ * Description  : Write the events waiting in SRAM, even if their page is
+ *                not full
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_flush(void);
+
+
+/**************************************************************************
+ * Function Name: AUDIT_isPending
+ * Description  : Tell if some events are waiting in SRAM
+ * INPUTS       : void
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean AUDIT_isPending(void);
+
+
+/**************************************************************************
+ * Function Name: AUDIT_getOldest
+ * Description  : SEQ of the oldest event kept in the log
+ * INPUTS       : void
+ * RETURNS      : uint16
+ **************************************************************************/
+uint16 AUDIT_getOldest(void);
+
+
+/**************************************************************************
+ * Function Name: AUDIT_read
+ * Description  : Decode consecutive events in order, from the block holding
+ *                the first one. Events already overwritten and blocks that
+ *                fail their CRC are skipped. A block is read once (only its
+ *                used bytes) and kept in SRAM for the next calls.
+ * INPUTS       : seq (first event wanted, set to the first event read),
+ *                data (count * AUDIT_RECORD_SIZE bytes),
+ *                count (records wanted, set to the records read, 0 at the end)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_read(uint16 *seq, uint8 *data, uint8 *count);
+
+
+#endif /* AUDIT_H_ */
@@ -0,0 +1,55 @@
+/*===========================================================================================
+ * Filename   : clock.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the monotonic millisecond/microsecond clock
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "std_types.h"
+#include "tick.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* The clock is the 1 ms tick plus the live Timer1 count, it needs no timer
+ * of its own and starts with TICK_init. A timestamp is a plain uint32, the
+ * time between two of them is (end - start), right across the wrap around
+ * as long as it is shorter than one wrap:
+ * CLOCK_millis ~49 days, CLOCK_micros ~71 minutes */
+
+#if (TICK_COUNTS_PER_MS < 1000UL)
+/* resolution of CLOCK_micros is one Timer1 count */
+#define CLOCK_RESOLUTION_US     (1000UL / TICK_COUNTS_PER_MS)
+#else
+#define CLOCK_RESOLUTION_US     (1UL)
+#endif
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: CLOCK_millis
+ * Description  : Timestamp in milliseconds since TICK_init, safe to call
+ *                from an ISR
+ * INPUTS       : void
+ * RETURNS      : uint32 (milliseconds, wraps around after ~49 days)
+ **************************************************************************/
+uint32 CLOCK_millis(void);
+
+
+/**************************************************************************
+ * Function Name: CLOCK_micros
+ * Description  : Timestamp in microseconds since TICK_init, to
+ *                CLOCK_RESOLUTION_US, safe to call from an ISR
+ * INPUTS       : void
+ * RETURNS      : uint32 (microseconds, wraps around after ~71 minutes)
+ **************************************************************************/
+uint32 CLOCK_micros(void);
+
+#endif /* CLOCK_H_ */
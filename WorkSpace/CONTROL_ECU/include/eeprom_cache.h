@@ -0,0 +1,56 @@
+/*===========================================================================================
+ * Filename   : eeprom_cache.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the write-through SRAM cache of an EEPROM region
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef EEPROM_CACHE_H_
+#define EEPROM_CACHE_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* SRAM reserved for the cached region */
+#define EEPROM_CACHE_SIZE    (16U)
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_init
+ * Description  : Load a region of the EEPROM in SRAM and keep the CRC of the
+ *                copy, reads inside the region are served from SRAM after it
+ * INPUTS       : address (start of the region), length (at most EEPROM_CACHE_SIZE)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status of the failed load)
+ **************************************************************************/
+uint8 EEPROM_CACHE_init(uint32 address, uint8 length);
+
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_read
+ * Description  : Read a range, from SRAM if it is inside the cached region
+ *                and the copy passes its CRC check, else from the EEPROM
+ *                (the region is reloaded when the copy is stale)
+ * INPUTS       : address (first address to read from), data && length
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_CACHE_read(uint32 address, uint8 *data, uint16 length);
+
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_write
+ * Description  : Write a range to the EEPROM and, once it is accepted, to
+ *                the part of the cached region it covers
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_CACHE_write(uint32 address, const uint8 *data, uint16 length);
+
+
+#endif /* EEPROM_CACHE_H_ */
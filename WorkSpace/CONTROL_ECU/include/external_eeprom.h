@@ -1,7 +1,7 @@
 /*===========================================================================================
  * Filename   : external_eprom.h
  * Author     : Ahmad Haroun
- * Description: Header File for a 2KB EXTERNAL_EEPROM DRIVER
+ * Description: Header File for the 24Cxx EXTERNAL_EEPROM DRIVER, one or more chips
  * Created on : SEP 4, 2023
  *==========================================================================================*/
 
@@ -17,29 +17,201 @@
  *******************************************************************************/
 
 #define SUCCESS  1
-#define ERROR    0
+#define ERROR    0			/* the EEPROM did not acknowledge */
+#define EEPROM_TIMEOUT    2	/* the bus was stuck (it has been recovered) or a write cycle never ended */
+#define EEPROM_BUS_ERROR  3	/* arbitration lost or illegal START/STOP on the bus */
+#define EEPROM_OUT_OF_RANGE 4	/* the address range does not fit the page or the device */
+#define EEPROM_NO_RECORD  5	/* neither copy of a record is valid (never written or both corrupted) */
+
+/* supported parts, EEPROM_DEVICE selects the one fitted on the board */
+#define EEPROM_24C16           (16U)
+#define EEPROM_24C32           (32U)
+#define EEPROM_24C64           (64U)
+#define EEPROM_24C128          (128U)
+#define EEPROM_24C256          (256U)
+#define EEPROM_24C512          (512U)
+
+#define EEPROM_DEVICE          EEPROM_24C16
+
+/* identical chips on the bus, strapped with A2..A0 = 0, 1, 2 .. in order.
+ * They are seen as one linear address space, chip n starts at n * EEPROM_CHIP_SIZE */
+#define EEPROM_CHIPS           (1U)
+
+/* geometry of one chip, a write transaction must stay inside one page.
+ * Up to 24C16 the memory address is one byte and its upper bits go in the
+ * slave address (they take A2..A0), bigger parts take a 2-byte address */
+#if (EEPROM_DEVICE == EEPROM_24C16)
+#define EEPROM_CHIP_SIZE       (2048UL)
+#define EEPROM_PAGE_SIZE       (16U)
+#define EEPROM_ADDRESS_BYTES   (1U)
+#elif (EEPROM_DEVICE == EEPROM_24C32)
+#define EEPROM_CHIP_SIZE       (4096UL)
+#define EEPROM_PAGE_SIZE       (32U)
+#define EEPROM_ADDRESS_BYTES   (2U)
+#elif (EEPROM_DEVICE == EEPROM_24C64)
+#define EEPROM_CHIP_SIZE       (8192UL)
+#define EEPROM_PAGE_SIZE       (32U)
+#define EEPROM_ADDRESS_BYTES   (2U)
+#elif (EEPROM_DEVICE == EEPROM_24C128)
+#define EEPROM_CHIP_SIZE       (16384UL)
+#define EEPROM_PAGE_SIZE       (64U)
+#define EEPROM_ADDRESS_BYTES   (2U)
+#elif (EEPROM_DEVICE == EEPROM_24C256)
+#define EEPROM_CHIP_SIZE       (32768UL)
+#define EEPROM_PAGE_SIZE       (64U)
+#define EEPROM_ADDRESS_BYTES   (2U)
+#elif (EEPROM_DEVICE == EEPROM_24C512)
+#define EEPROM_CHIP_SIZE       (65536UL)
+#define EEPROM_PAGE_SIZE       (128U)
+#define EEPROM_ADDRESS_BYTES   (2U)
+#else
+#error "EEPROM_DEVICE is not a supported part"
+#endif
+
+/* 7-bit TWI address of the first chip */
+#define EEPROM_BASE_ADDRESS    (0x50U)
+
+/* size of the linear address space */
+#define EEPROM_SIZE            (EEPROM_CHIP_SIZE * EEPROM_CHIPS)
+
+/* the chips are on the TWI bus, every access is a bus transaction */
+#define EEPROM_ON_CHIP         (0U)
+
+/* a chip takes one slave address, or one per 256-byte block for the 1-byte address parts */
+#if (EEPROM_ADDRESS_BYTES == 1)
+#define EEPROM_SLAVE_ADDRESSES (EEPROM_CHIP_SIZE / 256U)
+#else
+#define EEPROM_SLAVE_ADDRESSES (1U)
+#endif
+
+#if ((EEPROM_CHIPS * EEPROM_SLAVE_ADDRESSES) > 8) || (EEPROM_CHIPS == 0)
+#error "A2..A0 select 8 slave addresses at most"
+#endif
+
+/* Power-fail safe records, two copies side by side:
+ * | SEQ | DATA (length bytes) | CRC_LOW | CRC_HIGH | SEQ | DATA | CRC_LOW | CRC_HIGH |
+ * CRC-16 is calculated over SEQ and DATA. An update writes the copy that is not
+ * the newest valid one, with the next SEQ, so the newest copy stays intact till
+ * the new one is complete and valid: an update is the write of one copy only.
+ */
+#define EEPROM_RECORD_COPY_SIZE(length)  ((length) + 3U)
+#define EEPROM_RECORD_SIZE(length)       (2U * EEPROM_RECORD_COPY_SIZE(length))
+
+/* worst case internal write cycle of the supported parts, after each committed page.
+ * The driver polls the EEPROM till it ACKs its address again and gives up
+ * after twice this time */
+#define EEPROM_WRITE_CYCLE_MS  (10U)
+
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
 
 
 
+/**************************************************************************
+ * Function Name: EEPROM_waitReady
+ * Description  : Wait for the end of the last write cycle, by polling the
+ *                EEPROM with its address till it ACKs. Every access does it
+ *                first, so a write returns as soon as its page is sent.
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+uint8 EEPROM_waitReady(void);
+
+
+
 /**************************************************************************
  * Function Name: EEPROM_writeByte
  * Description  : Write a byte in a specific address
- * INPUTS       : uint16 address(address to write in), uint8 data(data to be written)
- * RETURNS      : uint8 (status of Writing Success or Fail)
+ * INPUTS       : uint32 address(address to write in), uint8 data(data to be written)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+uint8 EEPROM_writeByte(uint32 address, uint8 data);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writePage
+ * Description  : Write up to one page in a single transaction, the range must
+ *                not cross a page boundary. Returns without waiting for the
+ *                write cycle, the next access waits for it.
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 EEPROM_writePage(uint32 address, const uint8 *data, uint8 length);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writeBlock
+ * Description  : Write any range, split on the page boundaries, each page is
+ *                one transaction started as soon as the previous page is
+ *                programmed
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
  **************************************************************************/
-uint8 EEPROM_writeByte(uint16 address, uint8 data);
+uint8 EEPROM_writeBlock(uint32 address, const uint8 *data, uint16 length);
 
 
 
 /**************************************************************************
  * Function Name: EEPROM_readByte
  * Description  : Read a byte from a specific address
- * INPUTS       : uint16 address(address to read from), uint8 *data(data to be read)
- * RETURNS      : uint8 (status of Writing Success or Fail)
+ * INPUTS       : uint32 address(address to read from), uint8 *data(data to be read)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+uint8 EEPROM_readByte(uint32 address, uint8* data);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_readBlock
+ * Description  : Read a range with one addressed sequential read per chip,
+ *                every byte is ACKed except the last one which is NACKed.
+ *                The address counter of the EEPROM crosses pages and blocks
+ *                by itself, not chips.
+ * INPUTS       : address (first address to read from), data (where to save
+ *                the bytes) && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 EEPROM_readBlock(uint32 address, uint8 *data, uint16 length);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_selectRecord
+ * Description  : Pick the newest valid copy of a record already read
+ * INPUTS       : copies (EEPROM_RECORD_SIZE(length) bytes), length (of DATA)
+ * RETURNS      : const uint8* (DATA of the newest valid copy, NULL_PTR if
+ *                neither copy is valid)
+ **************************************************************************/
+const uint8* EEPROM_selectRecord(const uint8 *copies, uint8 length);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_readRecord
+ * Description  : Read both copies of a record with one sequential read and
+ *                return the DATA of the newest valid one
+ * INPUTS       : address (of the first copy), data && length
+ * RETURNS      : uint8 (SUCCESS, EEPROM_NO_RECORD or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_readRecord(uint32 address, uint8 *data, uint8 length);
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writeRecord
+ * Description  : Update a record, the older (or invalid) copy is replaced
+ *                by the new DATA with the next SEQ. A reset during the write
+ *                leaves the previous value readable.
+ * INPUTS       : address (of the first copy), data && length
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE or the EEPROM status)
  **************************************************************************/
-uint8 EEPROM_readByte(uint16  address, uint8* data);
+uint8 EEPROM_writeRecord(uint32 address, const uint8 *data, uint8 length);
 
 #endif /* EXTERNAL_EEPROM_H_ */
@@ -0,0 +1,223 @@
+/*===========================================================================================
+ * Filename   : frame.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the HMI_ECU <-> CONTROL_ECU frame protocol
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frame Layout on the wire:
+ * | SYNC | OPCODE | SEQ | LENGTH | PAYLOAD[LENGTH] | CRC_LOW | CRC_HIGH |
+ * CRC-16 is calculated over OPCODE, SEQ, LENGTH and PAYLOAD
+ */
+#define FRAME_SYNC_BYTE              (0x7EU)
+#define FRAME_MAX_PAYLOAD            (32U)
+
+/* Requests sent by HMI_ECU */
+#define FRAME_OP_SET_PASSWORD        (0x01U)
+#define FRAME_OP_VERIFY_PASSWORD     (0x02U)
+#define FRAME_OP_OPEN_GATE           (0x03U)
+#define FRAME_OP_LOCK_SYSTEM         (0x04U)
+#define FRAME_OP_SET_BAUD_RATE       (0x05U)   /* payload: bitmask of the supported UART_BaudRate profiles
+                                                * + FRAME_SESSION_xxx */
+#define FRAME_OP_GET_STATS           (0x06U)   /* response: result + FRAME_STATS_NUM counters (uint16, little endian) */
+#define FRAME_OP_GET_PROVISIONED     (0x07U)   /* response: FRAME_RESULT_SUCCESS if a password is already set */
+#define FRAME_OP_ADD_USER            (0x08U)   /* payload: user flags + PIN, response: result + new user ID */
+#define FRAME_OP_REVOKE_USER         (0x09U)   /* payload: user ID */
+#define FRAME_OP_LIST_USERS          (0x0AU)   /* payload: first user ID, response: result + next first user ID
+                                                * (0 at the end) + (user ID, user flags) pairs */
+#define FRAME_OP_READ_AUDIT          (0x0BU)   /* payload: first SEQ (uint16, little endian), none for the oldest event,
+                                                * response: result + next SEQ + audit records (none at the end) */
+#define FRAME_OP_GET_DOOR_STATE      (0x0CU)   /* response: result + FRAME_DOOR_xxx + seconds left of the stage */
+#define FRAME_OP_ABORT_DOOR          (0x0DU)   /* the door closes back, response: FRAME_RESULT_FAIL if it is closed */
+
+/* second payload byte of FRAME_OP_SET_BAUD_RATE: HMI_ECU found Control_ECU
+ * again after a timeout, or it was reset and its SEQ numbers start over */
+#define FRAME_SESSION_RESUMED        (0U)
+#define FRAME_SESSION_NEW            (1U)
+
+/* A response carries the opcode and sequence number of its request with this bit set */
+#define FRAME_OP_RESPONSE            (0x80U)
+
+/* First payload byte of a response */
+#define FRAME_RESULT_FAIL            (0U)
+#define FRAME_RESULT_SUCCESS         (1U)
+#define FRAME_RESULT_STORAGE_ERROR   (2U)      /* request not served, the EEPROM could not be accessed */
+#define FRAME_RESULT_TIMEOUT         (0xFFU)   /* never sent, reported locally when no response arrived */
+
+/* user flags, FRAME_OP_VERIFY_PASSWORD answers with result + user ID + user flags,
+ * user ID 0 is the system password set by FRAME_OP_SET_PASSWORD */
+#define FRAME_USER_ADMIN             (0x02U)
+
+/* stages of the door cycle, reported by FRAME_OP_GET_DOOR_STATE */
+#define FRAME_DOOR_CLOSED            (0U)
+#define FRAME_DOOR_OPENING           (1U)
+#define FRAME_DOOR_HOLDING           (2U)      /* open, waiting before it closes */
+#define FRAME_DOOR_CLOSING           (3U)
+
+/* audit records sent by FRAME_OP_READ_AUDIT:
+ * | SEQ_LOW | SEQ_HIGH | TIME (3 bytes, seconds since the reset) | EVENT | USER_ID | RESULT |
+ * USER_ID is 0xFF for an event that is not tied to a user, RESULT is FRAME_RESULT_xxx */
+#define FRAME_AUDIT_RECORD_SIZE      (8U)
+#define FRAME_EVENT_BOOT             (0U)      /* Control_ECU started */
+#define FRAME_EVENT_ACCESS_GRANTED   (1U)
+#define FRAME_EVENT_ACCESS_DENIED    (2U)
+#define FRAME_EVENT_LOCKOUT          (3U)      /* all the trials are used, the buzzer is on */
+#define FRAME_EVENT_DOOR_OPENED      (4U)
+#define FRAME_EVENT_PASSWORD_SET     (5U)
+#define FRAME_EVENT_USER_ADDED       (6U)
+#define FRAME_EVENT_USER_REVOKED     (7U)
+
+/* timeout value for FRAME_receive to wait until a frame arrives */
+#define FRAME_WAIT_FOREVER           (0U)
+
+/* a frame whose bytes stop for this long is dropped, so it can not merge with the next one */
+#define FRAME_BYTE_TIMEOUT_MS        (20U)
+
+/* unit of the FRAME_STAT_ROUND_TRIP counter, so it holds up to 6.5 s */
+#define FRAME_ROUND_TRIP_UNIT_US     (100UL)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef struct
+{
+	uint8 opcode;
+	uint8 seq;
+	uint8 length;
+	uint8 payload[FRAME_MAX_PAYLOAD];
+}FRAME_Type;
+
+/* index of each counter in the link statistics array */
+typedef enum
+{
+	FRAME_STAT_FRAMES_SENT,
+	FRAME_STAT_FRAMES_RECEIVED,
+	FRAME_STAT_CRC_ERRORS,          /* frames dropped for a bad CRC or length */
+	FRAME_STAT_TIMEOUTS,            /* tries of FRAME_transact that got no response */
+	FRAME_STAT_RETRIES,             /* requests sent again by FRAME_transact */
+	FRAME_STAT_ROUND_TRIP,          /* last FRAME_transact try that got its response, in FRAME_ROUND_TRIP_UNIT_US */
+	FRAME_STAT_OVERRUN_ERRORS,      /* from the UART driver */
+	FRAME_STAT_FRAMING_ERRORS,
+	FRAME_STAT_PARITY_ERRORS,
+	FRAME_STAT_BUFFER_OVERRUNS,
+	FRAME_STATS_NUM,
+}FRAME_StatIndex;
+
+typedef enum
+{
+	FRAME_INCOMPLETE,
+	FRAME_COMPLETE,
+	FRAME_ERROR,
+	FRAME_TIMEOUT,
+}FRAME_StatusType;
+
+typedef enum
+{
+	FRAME_STATE_SYNC,
+	FRAME_STATE_OPCODE,
+	FRAME_STATE_SEQ,
+	FRAME_STATE_LENGTH,
+	FRAME_STATE_PAYLOAD,
+	FRAME_STATE_CRC_LOW,
+	FRAME_STATE_CRC_HIGH,
+}FRAME_ParserState;
+
+typedef struct
+{
+	FRAME_ParserState state;
+	uint8 index;                 /* next payload byte to be filled */
+	uint16 crc;                  /* running CRC of the frame being parsed */
+	uint8 crc_low;               /* received low byte of the CRC */
+	FRAME_Type frame;
+}FRAME_ParserType;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: FRAME_initParser
+ * Description  : Reset the parser to wait for a new SYNC byte
+ * INPUTS       : parser (parser to be reset)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_initParser(FRAME_ParserType *parser);
+
+
+/**************************************************************************
+ * Function Name: FRAME_parseByte
+ * Description  : Feed the parser with one received byte
+ * INPUTS       : parser, byte (the received byte)
+ * RETURNS      : FRAME_StatusType
+ *                FRAME_INCOMPLETE ==> frame is not finished yet
+ *                FRAME_COMPLETE   ==> parser->frame holds a valid frame
+ *                FRAME_ERROR      ==> bad length or CRC, the frame is dropped
+ **************************************************************************/
+FRAME_StatusType FRAME_parseByte(FRAME_ParserType *parser, uint8 byte);
+
+
+/**************************************************************************
+ * Function Name: FRAME_send
+ * Description  : Build a frame and send it through the UART
+ * INPUTS       : opcode, seq, payload, length (must not exceed FRAME_MAX_PAYLOAD)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_send(uint8 opcode, uint8 seq, const uint8 *payload, uint8 length);
+
+
+/**************************************************************************
+ * Function Name: FRAME_receive
+ * Description  : Wait until a complete valid frame is received,
+ *                corrupted frames are silently dropped
+ * INPUTS       : frame (where the received frame is saved),
+ *                timeout_ms (deadline for the whole frame or FRAME_WAIT_FOREVER)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_TIMEOUT)
+ **************************************************************************/
+FRAME_StatusType FRAME_receive(FRAME_Type *frame, uint16 timeout_ms);
+
+
+/**************************************************************************
+ * Function Name: FRAME_poll
+ * Description  : Feed the parser with the bytes already received, without
+ *                waiting, corrupted frames are silently dropped and a
+ *                partial frame is kept for the next call
+ * INPUTS       : frame (where the received frame is saved)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_INCOMPLETE)
+ **************************************************************************/
+FRAME_StatusType FRAME_poll(FRAME_Type *frame);
+
+
+/**************************************************************************
+ * Function Name: FRAME_transact
+ * Description  : Send a request and wait for its response, responses that
+ *                do not match the request opcode and sequence are dropped,
+ *                the request is sent again (same sequence) when no response arrives
+ * INPUTS       : request, response (where the response is saved),
+ *                timeout_ms (wait for each try), retries (extra tries after the first)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_TIMEOUT)
+ **************************************************************************/
+FRAME_StatusType FRAME_transact(const FRAME_Type *request, FRAME_Type *response, uint16 timeout_ms, uint8 retries);
+
+
+
+/**************************************************************************
+ * Function Name: FRAME_getStats
+ * Description  : Get the link statistics of this ECU (frame and UART counters)
+ * INPUTS       : stats (array of FRAME_STATS_NUM counters indexed by FRAME_StatIndex)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_getStats(uint16 *stats);
+
+#endif /* FRAME_H_ */
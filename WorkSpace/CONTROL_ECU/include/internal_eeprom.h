@@ -0,0 +1,69 @@
+/*===========================================================================================
+ * Filename   : internal_eeprom.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the on-chip EEPROM of the ATmega32 (avr-libc eeprom.h)
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef INTERNAL_EEPROM_H_
+#define INTERNAL_EEPROM_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"	/* status codes shared by the storage backends */
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define INTERNAL_EEPROM_SIZE       (1024UL)
+#define INTERNAL_EEPROM_ON_CHIP    (1U)
+
+/* The on-chip EEPROM is written byte by byte (~8.5 ms each, the CPU waits for
+ * every byte but the last one), it has no page buffer. A "page" only bounds
+ * the range of INTERNAL_EEPROM_writePage, it is big enough for the layouts
+ * made of whole pages of the external EEPROM */
+#define INTERNAL_EEPROM_PAGE_SIZE  (128U)
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_waitReady
+ * Description  : Wait for the end of the last byte write
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_waitReady(void);
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_writePage
+ * Description  : Write a range that does not cross a page boundary
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_writePage(uint32 address, const uint8 *data, uint8 length);
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_writeBlock
+ * Description  : Write any range, the bytes that already hold their value
+ *                are skipped (no write cycle, no wear)
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_writeBlock(uint32 address, const uint8 *data, uint16 length);
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_readBlock
+ * Description  : Read any range, a few CPU cycles per byte
+ * INPUTS       : address (first address to read from), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_readBlock(uint32 address, uint8 *data, uint16 length);
+
+
+#endif /* INTERNAL_EEPROM_H_ */
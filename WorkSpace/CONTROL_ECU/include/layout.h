@@ -0,0 +1,121 @@
+/*===========================================================================================
+ * Filename   : layout.h
+ * Author     : Ahmad Haroun
+ * Description: Layout manifest, every persistent region of the internal and external EEPROMs
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include "std_types.h"
+#include "storage.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Placement helpers, a region is named by the XXX of its LAYOUT_XXX_ macros */
+#define LAYOUT_ALIGN(address, alignment)  ((((address) + (alignment) - 1UL) / (alignment)) * (alignment))
+#define LAYOUT_BACKEND(region)            LAYOUT_##region##_BACKEND
+#define LAYOUT_SIZE(region)               LAYOUT_##region##_SIZE
+#define LAYOUT_ALIGNMENT(region)          LAYOUT_##region##_ALIGN
+#define LAYOUT_START(region)              LAYOUT_##region##_START
+#define LAYOUT_END(region)                (LAYOUT_START(region) + LAYOUT_SIZE(region))
+#define LAYOUT_PAGE_SIZE(region)          STORAGE_PAGE_SIZE(LAYOUT_BACKEND(region))
+#define LAYOUT_ON_CHIP(region)            STORAGE_IS_ON_CHIP(LAYOUT_BACKEND(region))
+
+/*******************************************************************************
+ * Manifest, one chain of regions per EEPROM, in placement order. A region
+ * starts on the first address after the region before it on the same EEPROM
+ * that meets its alignment (whole pages at least).
+ * A new persistent feature adds its region at the end of a chain (so the
+ * others keep their addresses) and to the checks below.
+ *******************************************************************************/
+
+/* On-chip EEPROM */
+
+/* record store (credential), read at every attempt so it needs no bus transaction */
+#define LAYOUT_STORE_BACKEND              STORAGE_INTERNAL
+#define LAYOUT_STORE_SIZE                 (0x0200UL)
+#define LAYOUT_STORE_ALIGN                LAYOUT_PAGE_SIZE(STORE)
+#define LAYOUT_STORE_START                LAYOUT_ALIGN(0UL, LAYOUT_STORE_ALIGN)
+
+/* scratch area of STORAGE_benchmark, empty when it is not built */
+#define LAYOUT_BENCH_INTERNAL_BACKEND     STORAGE_INTERNAL
+#define LAYOUT_BENCH_INTERNAL_SIZE        (STORAGE_BENCHMARK * STORAGE_BENCH_LENGTH)
+#define LAYOUT_BENCH_INTERNAL_ALIGN       LAYOUT_PAGE_SIZE(BENCH_INTERNAL)
+#define LAYOUT_BENCH_INTERNAL_START       LAYOUT_ALIGN(LAYOUT_STORE_START + LAYOUT_STORE_SIZE, LAYOUT_BENCH_INTERNAL_ALIGN)
+
+#define LAYOUT_INTERNAL_LAST              BENCH_INTERNAL
+
+/* External EEPROM */
+
+/* user table, 32 A/B records of 16 bytes */
+#define LAYOUT_USERS_BACKEND              STORAGE_EXTERNAL
+#define LAYOUT_USERS_SIZE                 (0x0200UL)
+#define LAYOUT_USERS_ALIGN                LAYOUT_PAGE_SIZE(USERS)
+#define LAYOUT_USERS_START                LAYOUT_ALIGN(0UL, LAYOUT_USERS_ALIGN)
+
+/* audit log ring, whole blocks of 64 bytes (or of a page, if bigger) */
+#define LAYOUT_AUDIT_BACKEND              STORAGE_EXTERNAL
+#define LAYOUT_AUDIT_SIZE                 (0x0500UL)
+#define LAYOUT_AUDIT_ALIGN                LAYOUT_PAGE_SIZE(AUDIT)
+#define LAYOUT_AUDIT_START                LAYOUT_ALIGN(LAYOUT_USERS_START + LAYOUT_USERS_SIZE, LAYOUT_AUDIT_ALIGN)
+
+#define LAYOUT_BENCH_EXTERNAL_BACKEND     STORAGE_EXTERNAL
+#define LAYOUT_BENCH_EXTERNAL_SIZE        (STORAGE_BENCHMARK * STORAGE_BENCH_LENGTH)
+#define LAYOUT_BENCH_EXTERNAL_ALIGN       LAYOUT_PAGE_SIZE(BENCH_EXTERNAL)
+#define LAYOUT_BENCH_EXTERNAL_START       LAYOUT_ALIGN(LAYOUT_AUDIT_START + LAYOUT_AUDIT_SIZE, LAYOUT_BENCH_EXTERNAL_ALIGN)
+
+#define LAYOUT_EXTERNAL_LAST              BENCH_EXTERNAL
+
+/*******************************************************************************
+ * Checks, the build fails when a region is in the chain of the other EEPROM
+ * (it would overlap a region there), is not page aligned or does not fit.
+ *******************************************************************************/
+
+#define LAYOUT_IS_ALIGNED(region)  (((LAYOUT_ALIGNMENT(region) % LAYOUT_PAGE_SIZE(region)) == 0) && \
+                                    ((LAYOUT_START(region) % LAYOUT_ALIGNMENT(region)) == 0))
+
+#if (LAYOUT_ON_CHIP(STORE) != 1) || (LAYOUT_ON_CHIP(BENCH_INTERNAL) != 1) || \
+    (LAYOUT_ON_CHIP(USERS) != 0) || (LAYOUT_ON_CHIP(AUDIT) != 0) || (LAYOUT_ON_CHIP(BENCH_EXTERNAL) != 0)
+#error "a region is placed in the chain of the other EEPROM"
+#endif
+
+#if !LAYOUT_IS_ALIGNED(STORE) || !LAYOUT_IS_ALIGNED(BENCH_INTERNAL) || \
+    !LAYOUT_IS_ALIGNED(USERS) || !LAYOUT_IS_ALIGNED(AUDIT) || !LAYOUT_IS_ALIGNED(BENCH_EXTERNAL)
+#error "a region alignment is not whole pages"
+#endif
+
+#if (LAYOUT_END(LAYOUT_INTERNAL_LAST) > INTERNAL_EEPROM_SIZE)
+#error "the regions do not fit in the on-chip EEPROM"
+#endif
+
+#if (LAYOUT_END(LAYOUT_EXTERNAL_LAST) > EEPROM_SIZE)
+#error "the regions do not fit in the external EEPROM"
+#endif
+
+/*******************************************************************************
+ * Accessors, offsets are relative to the region. The region starts on a page
+ * so a page of the region is a page of the EEPROM: a block written at a
+ * multiple of the page size is one write cycle per page.
+ *   LAYOUT_read(region, offset, data, length)
+ *   LAYOUT_write(region, offset, data, length)       split on the pages
+ *   LAYOUT_writePage(region, offset, data, length)   one page at most
+ *   LAYOUT_sync(region)                              end of the last write
+ *******************************************************************************/
+
+#define LAYOUT_ADDRESS(region, offset)   (LAYOUT_START(region) + (offset))
+
+#define LAYOUT_read(region, offset, data, length) \
+	STORAGE_read(LAYOUT_BACKEND(region))(LAYOUT_ADDRESS(region, offset), (data), (length))
+#define LAYOUT_write(region, offset, data, length) \
+	STORAGE_write(LAYOUT_BACKEND(region))(LAYOUT_ADDRESS(region, offset), (data), (length))
+#define LAYOUT_writePage(region, offset, data, length) \
+	STORAGE_writePage(LAYOUT_BACKEND(region))(LAYOUT_ADDRESS(region, offset), (data), (length))
+#define LAYOUT_sync(region) \
+	STORAGE_sync(LAYOUT_BACKEND(region))()
+
+
+#endif /* LAYOUT_H_ */
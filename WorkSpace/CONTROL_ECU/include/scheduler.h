@@ -0,0 +1,74 @@
+/*===========================================================================================
+ * Filename   : scheduler.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the cooperative run-to-completion task scheduler
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* One FIFO queue of tasks per priority, the higher priority queue is always
+ * served first. A task is linked in its queue through its own descriptor, so
+ * a queue never fills up and nothing is allocated */
+#define SCHEDULER_PRIORITIES        (2U)
+#define SCHEDULER_PRIORITY_HIGH     (0U)	/* events posted by the ISRs */
+#define SCHEDULER_PRIORITY_LOW      (1U)	/* the application work */
+
+/* initializer of a task descriptor */
+#define SCHEDULER_TASK(run, priority)   {NULL_PTR, (run), (priority), FALSE}
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/********************************************************************************
+ * Task descriptor, owned by the caller (no heap). A task runs to completion:
+ * it must return quickly, the latency of every other task and timer is the
+ * longest run of a task. The fields are private to scheduler.c.
+ *********************************************************************************/
+typedef struct SCHEDULER_Task
+{
+	struct SCHEDULER_Task *volatile next;	/* next task of the same queue */
+	void (*run)(void);
+	uint8 priority;
+	volatile boolean queued;
+}SCHEDULER_TaskType;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: SCHEDULER_post
+ * Description  : Queue a task to be run once, from the main loop or an ISR.
+ *                Posting a task that is still queued does nothing, so an
+ *                event that happens again before it is served costs nothing
+ *                (the task reads what is pending, e.g. a whole RX buffer)
+ * INPUTS       : task
+ * RETURNS      : void
+ **************************************************************************/
+void SCHEDULER_post(SCHEDULER_TaskType *task);
+
+
+/**************************************************************************
+ * Function Name: SCHEDULER_run
+ * Description  : Event loop, never returns. Calls the callBacks of the
+ *                expired software timers, then runs the next queued task,
+ *                and puts the CPU in idle sleep when there is nothing to do
+ *                (any interrupt wakes it, the 1 ms tick at least)
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void SCHEDULER_run(void);
+
+
+#endif /* SCHEDULER_H_ */
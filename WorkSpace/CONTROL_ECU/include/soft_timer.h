@@ -0,0 +1,101 @@
+/*===========================================================================================
+ * Filename   : soft_timer.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the software timers, a timer wheel driven by the 1 ms tick
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef SOFT_TIMER_H_
+#define SOFT_TIMER_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Slots of the wheel, one per millisecond of a turn. A timer is linked in the
+ * slot of its expiry, so starting or stopping one is O(1) and every tick
+ * only looks at the timers of one slot. A power of 2 */
+#define SOFT_TIMER_SLOTS      (32U)
+
+#if ((SOFT_TIMER_SLOTS & (SOFT_TIMER_SLOTS - 1)) != 0) || (SOFT_TIMER_SLOTS > 256)
+#error "SOFT_TIMER_SLOTS must be a power of 2, not bigger than 256"
+#endif
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/********************************************************************************
+ * Timer descriptor, owned by the caller (no heap) and must stay alive while
+ * it is started. The fields are private to soft_timer.c.
+ *********************************************************************************/
+typedef struct SOFT_TIMER_Timer
+{
+	struct SOFT_TIMER_Timer *next;		/* timers of the same slot */
+	struct SOFT_TIMER_Timer *prev;
+	uint32 expiry;						/* tick of the expiry */
+	uint32 period;						/* 0 for a one-shot timer */
+	void (*callBack)(void);
+	boolean active;
+}SOFT_TIMER_Type;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_start
+ * Description  : Start (or restart) a timer, its callBack is called by
+ *                SOFT_TIMER_process after delay_ms, then every period_ms
+ *                if it is periodic. Not to be called from an ISR.
+ * INPUTS       : timer, delay_ms (at least 1), period_ms (0 for one-shot),
+ *                callBack
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_start(SOFT_TIMER_Type *timer, uint32 delay_ms, uint32 period_ms, void (*callBack)(void));
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_stop
+ * Description  : Stop a timer, nothing happens if it is not started
+ * INPUTS       : timer
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_stop(SOFT_TIMER_Type *timer);
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_isActive
+ * Description  : Tell if a timer is started and not expired yet (a periodic
+ *                timer stays active till it is stopped)
+ * INPUTS       : timer
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean SOFT_TIMER_isActive(const SOFT_TIMER_Type *timer);
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_getRemaining
+ * Description  : Time left before the next expiry of a timer
+ * INPUTS       : timer
+ * RETURNS      : uint32 (milliseconds, 0 if it is stopped or already due)
+ **************************************************************************/
+uint32 SOFT_TIMER_getRemaining(const SOFT_TIMER_Type *timer);
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_process
+ * Description  : Move the wheel up to the current tick and call the
+ *                callBack of every expired timer, in the main loop context.
+ *                A callBack may start or stop any timer.
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_process(void);
+
+
+#endif /* SOFT_TIMER_H_ */
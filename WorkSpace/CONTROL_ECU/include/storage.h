@@ -0,0 +1,91 @@
+/*===========================================================================================
+ * Filename   : storage.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the storage interface over the internal and external EEPROMs
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+#include "internal_eeprom.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Backends, a module picks one at compile time with its own XXX_BACKEND.
+ * A backend is the prefix of a driver that provides:
+ *   _readBlock(uint32, uint8*, uint16), _writeBlock(uint32, const uint8*, uint16),
+ *   _writePage(uint32, const uint8*, uint8), _waitReady(void),
+ *   _SIZE, _PAGE_SIZE and _ON_CHIP
+ * and the EEPROM status codes. The calls are bound by the preprocessor, so
+ * they cost the same as calling the driver directly.
+ */
+#define STORAGE_EXTERNAL      EEPROM			/* 24Cxx on the TWI bus */
+#define STORAGE_INTERNAL      INTERNAL_EEPROM	/* on-chip EEPROM, no bus transaction */
+
+#define STORAGE_PASTE(backend, name)     backend##_##name
+#define STORAGE_BIND(backend, name)      STORAGE_PASTE(backend, name)
+
+/* STORAGE_read(backend)(address, data, length) .. */
+#define STORAGE_read(backend)            STORAGE_BIND(backend, readBlock)
+#define STORAGE_write(backend)           STORAGE_BIND(backend, writeBlock)
+#define STORAGE_writePage(backend)       STORAGE_BIND(backend, writePage)
+#define STORAGE_sync(backend)            STORAGE_BIND(backend, waitReady)
+
+/* usable in #if too */
+#define STORAGE_SIZE(backend)            STORAGE_BIND(backend, SIZE)
+#define STORAGE_PAGE_SIZE(backend)       STORAGE_BIND(backend, PAGE_SIZE)
+#define STORAGE_IS_ON_CHIP(backend)      STORAGE_BIND(backend, ON_CHIP)
+
+/* set to 1 to build STORAGE_benchmark, its scratch areas are in layout.h */
+#define STORAGE_BENCHMARK     (0U)
+
+/* a record of the size of a store slot, read and written this many times */
+#define STORAGE_BENCH_LENGTH  (16U)
+
+#if (STORAGE_BENCHMARK == 1)
+
+#define STORAGE_BENCH_READS   (256U)
+#define STORAGE_BENCH_WRITES  (8U)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint32 read_us;		/* one read of STORAGE_BENCH_LENGTH bytes */
+	uint32 write_us;	/* one write of STORAGE_BENCH_LENGTH bytes, till it is programmed */
+}STORAGE_LatencyType;
+
+typedef struct
+{
+	STORAGE_LatencyType internal;
+	STORAGE_LatencyType external;
+}STORAGE_BenchmarkType;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: STORAGE_benchmark
+ * Description  : Measure the average read and write latency of both
+ *                backends with CLOCK_micros, over many accesses. Run it on
+ *                the target (the tick and the TWI must be initialized) and
+ *                read the result with the debugger, it takes about 1.5 s.
+ * INPUTS       : result
+ * RETURNS      : uint8 (SUCCESS or the status of the failed access)
+ **************************************************************************/
+uint8 STORAGE_benchmark(STORAGE_BenchmarkType *result);
+
+#endif /* STORAGE_BENCHMARK */
+
+
+#endif /* STORAGE_H_ */
@@ -0,0 +1,107 @@
+/*===========================================================================================
+ * Filename   : store.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the log-structured key/record store over an EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef STORE_H_
+#define STORE_H_
+
+#include "std_types.h"
+#include "layout.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* area of the store, placed by the layout manifest. On-chip a slot write is
+ * ~136 ms of byte writes, on the 24Cxx it is one page write */
+#define STORE_BACKEND         LAYOUT_BACKEND(STORE)
+#define STORE_SIZE            LAYOUT_SIZE(STORE)
+
+/* Every record takes one slot, slots never cross a page:
+ * | KEY | LENGTH | SEQ_LOW | SEQ_HIGH | VALUE (10 bytes) | CRC_LOW | CRC_HIGH |
+ * CRC-16 is calculated over KEY, LENGTH, SEQ and VALUE.
+ * Records are appended at the head of a circular log, a new value of a key
+ * is a new record with the next SEQ and the old one is simply forgotten.
+ */
+#define STORE_SLOT_SIZE       (16U)
+#define STORE_SLOTS           (STORE_SIZE / STORE_SLOT_SIZE)
+#define STORE_HEADER_SIZE     (4U)
+#define STORE_MAX_VALUE       (STORE_SLOT_SIZE - STORE_HEADER_SIZE - 2U)
+
+/* keys are 0 .. STORE_MAX_KEYS-1, the RAM index has one slot number per key */
+#define STORE_MAX_KEYS        (8U)
+
+/* slots kept free in front of the head, so a live record can always be moved */
+#define STORE_RESERVE_SLOTS   (1U)
+
+#if ((STORE_SIZE % LAYOUT_PAGE_SIZE(STORE)) != 0) || ((LAYOUT_PAGE_SIZE(STORE) % STORE_SLOT_SIZE) != 0)
+#error "the store must be made of whole EEPROM pages, each holding whole slots"
+#endif
+
+#if (STORE_SLOTS > 255) || (STORE_SLOTS <= (STORE_MAX_KEYS + STORE_RESERVE_SLOTS + 1))
+#error "STORE_SLOTS must fit in uint8 and leave room for the garbage collection"
+#endif
+
+/* status codes besides the EEPROM ones */
+#define STORE_NOT_FOUND       (6U)	/* the key has never been written */
+
+/* Keys in use */
+#define STORE_KEY_CREDENTIAL  (0U)
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: STORE_mount
+ * Description  : Scan every slot once and build the RAM index (newest valid
+ *                record of each key), the head (after the newest record)
+ *                and the tail (oldest live record).
+ *                Mount time is bounded by the store size: every slot is a
+ *                CRC over 14 bytes (~0.2 ms at 8 MHz) plus one read, a few us
+ *                on-chip or 19 bytes on the bus (~0.45 ms at 400 kHz), so
+ *                about 7 ms for the 32 slots of 512 bytes on-chip (21 ms on
+ *                the external EEPROM), whatever the content is.
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_mount(void);
+
+
+/**************************************************************************
+ * Function Name: STORE_read
+ * Description  : Read the newest value of a key, with one block read
+ * INPUTS       : key, data (at least STORE_MAX_VALUE bytes), length (value length)
+ * RETURNS      : uint8 (SUCCESS, STORE_NOT_FOUND, EEPROM_OUT_OF_RANGE for a
+ *                bad key, ERROR if the record fails its CRC, or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_read(uint8 key, uint8 *data, uint8 *length);
+
+
+/**************************************************************************
+ * Function Name: STORE_write
+ * Description  : Append a new value of a key at the head of the log, the
+ *                oldest slots are reclaimed first (live ones are moved to
+ *                the head) so every slot wears at the same rate
+ * INPUTS       : key, data && length (at most STORE_MAX_VALUE)
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_write(uint8 key, const uint8 *data, uint8 length);
+
+
+/**************************************************************************
+ * Function Name: STORE_setCachedKey
+ * Description  : Keep the record of one key in the SRAM cache, its reads
+ *                do not touch the bus any more (the cache follows the record
+ *                when it moves to a new slot). Nothing to do on-chip.
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void STORE_setCachedKey(uint8 key);
+
+
+#endif /* STORE_H_ */
@@ -0,0 +1,133 @@
+/*===========================================================================================
+ * Filename   : tick.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the millisecond system tick (Timer1)
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef TICK_H_
+#define TICK_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Timer1 runs in CTC mode, one compare match every 1 ms. The prescaler is
+ * resolved here for F_CPU: the smallest one (finest count) whose clock is a
+ * whole number of kHz with at most 65536 counts per ms, so the tick is exact.
+ * 1, 8, 12, 16 and 20 MHz all get prescaler 1 */
+#define TICK_PERIOD_EXACT(prescaler)    ((((F_CPU) % (prescaler)) == 0) && \
+                                         ((((F_CPU) / (prescaler)) % 1000UL) == 0) && \
+                                         ((((F_CPU) / (prescaler)) / 1000UL) <= 0x10000UL))
+
+#if TICK_PERIOD_EXACT(1UL)
+#define TICK_PRESCALER          (1UL)
+#define TICK_PRESCALER_ID       TIMER1_NO_PRESCALER
+#elif TICK_PERIOD_EXACT(8UL)
+#define TICK_PRESCALER          (8UL)
+#define TICK_PRESCALER_ID       TIMER1_PRESCALER_8
+#elif TICK_PERIOD_EXACT(64UL)
+#define TICK_PRESCALER          (64UL)
+#define TICK_PRESCALER_ID       TIMER1_PRESCALER_64
+#elif TICK_PERIOD_EXACT(256UL)
+#define TICK_PRESCALER          (256UL)
+#define TICK_PRESCALER_ID       TIMER1_PRESCALER_256
+#elif TICK_PERIOD_EXACT(1024UL)
+#define TICK_PRESCALER          (1024UL)
+#define TICK_PRESCALER_ID       TIMER1_PRESCALER_1024
+#else
+#error "F_CPU can not generate an exact 1 ms tick with any Timer1 prescaler"
+#endif
+
+#define TICK_TIMER_CLOCK        ((F_CPU) / TICK_PRESCALER)
+#define TICK_COUNTS_PER_MS      (TICK_TIMER_CLOCK / 1000UL)
+#define TICK_COMPARE_VALUE      (TICK_COUNTS_PER_MS - 1UL)
+
+/* Every delay or timeout is a whole number of ticks, so any duration in ms
+ * is exact. TICK_isExpired compares the signed distance to the deadline, so
+ * a duration is reachable up to half the counter range (~24.8 days).
+ * Constant durations are checked with it by the modules using them:
+ * #if !TICK_IS_REACHABLE(XXX_MS) ... #error */
+#define TICK_MAX_DELAY_MS       (0x7FFFFFFFUL)
+#define TICK_IS_REACHABLE(ms)   (((ms) >= 1UL) && ((ms) <= TICK_MAX_DELAY_MS))
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* milliseconds since TICK_init. It is extern only for TICK_onCompare, which
+ * is expanded in the TIMER1_COMPA ISR: no other module may write it, they
+ * read it with TICK_getMs or TICK_capture (a 32-bit read is not atomic) */
+extern volatile uint32 TICK_Counter;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: TICK_onCompare
+ * Description  : Handler of TIMER1_COMPA_vect (ISR context, bound in
+ *                isr_hooks.h), count one millisecond. Inline so the ISR
+ *                increments the counter itself, without any call
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+static inline void TICK_onCompare(void)
+{
+	TICK_Counter++;
+}
+
+
+/**************************************************************************
+ * Function Name: TICK_init
+ * Description  : Start Timer1 as a free running 1 ms tick, it is started
+ *                once and shared by all the delays and timeouts
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void TICK_init(void);
+
+
+/**************************************************************************
+ * Function Name: TICK_getMs
+ * Description  : Get the number of milliseconds since TICK_init
+ * INPUTS       : void
+ * RETURNS      : uint32 (milliseconds, wraps around after ~49 days)
+ **************************************************************************/
+uint32 TICK_getMs(void);
+
+
+/**************************************************************************
+ * Function Name: TICK_capture
+ * Description  : Get the milliseconds since TICK_init together with the
+ *                Timer1 count inside the current millisecond, both read
+ *                in the same critical section (also from an ISR)
+ * INPUTS       : count (0 .. TICK_COMPARE_VALUE)
+ * RETURNS      : uint32 (milliseconds)
+ **************************************************************************/
+uint32 TICK_capture(uint16 *count);
+
+
+/**************************************************************************
+ * Function Name: TICK_isExpired
+ * Description  : Check if a deadline (TICK_getMs() + timeout) has passed,
+ *                works across the counter wrap around
+ * INPUTS       : deadline (in milliseconds)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean TICK_isExpired(uint32 deadline);
+
+
+/**************************************************************************
+ * Function Name: TICK_delayMs
+ * Description  : Wait for a number of milliseconds using the shared tick
+ * INPUTS       : ms (time to wait)
+ * RETURNS      : void
+ **************************************************************************/
+void TICK_delayMs(uint32 ms);
+
+#endif /* TICK_H_ */
@@ -48,23 +48,6 @@ typedef enum
 	TIMER0_ENABLE_INTERRUPT,
 }INTERRUPT_SELECT;
 
-/*******************************************************************************
- *                               Global_Variables Declaration                  *
- *******************************************************************************/
-
-
-/********************************************************************************
- * Global Array of 4 pointers to function
- * 1.static to use in this file and hold his value
- * 2.volatile to use in ISRs function and in the function 'TIMER0_Set_CallBack'
- * 3.Initial value with Null or use NULL_Ptr in standard_types
- * TIMER0_OVF_vect    : INDEX 0
- * TIMER0_COMP        : INDEX 1
- *********************************************************************************/
-static volatile void (*TIMER0_CallBack_Array[2])(void) = {NULL_PTR};
-
-
-
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -100,14 +83,4 @@ void TIMER0_Init_CTC_Mode(uint16 Compare_Value,CTC_Output_Mode OutPutPin_Mode
 void TIMER0_Init_PWM_Mode(uint8 Compare_Value,PWM_Output_Mode OutPutPin_Mode
 		                  ,Clock_Pescaler Prescaler,INTERRUPT_SELECT Interrupt_Choice);
 
-
-
-/**********************************************************************************
- * Function Name: TIMER0_Set_CallBack
- * Description  : A Function to set the callBack functions for Timer0 Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
- * RETURNS      : void
- **********************************************************************************/
-void TIMER0_Set_CallBack(void(* ptr_2_fun)(void),uint8 index);
-
 #endif /* TIMER0_H_ */
@@ -71,24 +71,6 @@ typedef struct
 	Timer1_Mode mode;
 } Timer1_ConfigType;
 
-/*******************************************************************************
- *                               Global_Variables Declaration                  *
- *******************************************************************************/
-
-/********************************************************************************
- * Global Array of 4 pointers to function
- * 1.static to use in this file and hold his value
- * 2.volatile to use in ISRs function and in the function 'TIMER1_Set_CallBack'
- * 3.Initial value with Null or use NULL_Ptr in standard_types
- * TIMER1_OVF_vect    : INDEX 0
- * TIMER1_COMPA_vect  : INDEX 1
- * TIMER1_COMPB_vect  : INDEX 2
- * TIMER1_CAPT_vect   : INDEX 3
- *********************************************************************************/
-static volatile void (*TIMER1_CallBack_Array[4])(void) = {NULL_PTR};
-
-
-
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -133,15 +115,6 @@ void TIMER1_Init_PWM_Mode(uint8 Compare_Value,PWM_Output_Mode OutPutPin_Mode
 void TIMER1_Init_ICU_Mode(Clock_Pescaler Prescaler,INTERRUPT_SELECT Interrupt_Choice,ICU_EDGE_TYPE EDGE);
 
 
-/**********************************************************************************
- * Function Name: Set_CallBack
- * Description  : A Function to set the callBack functions for Timer1 Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
- * RETURNS      : void
- **********************************************************************************/
-void TIMER1_Set_CallBack(void(* ptr_2_fun)(void),uint8 index);
-
-
 /**********************************************************************************
  * Function Name: Timer1_init
  * Description  : A Function to initialze the Timer1
@@ -160,13 +133,4 @@ void Timer1_init(const Timer1_ConfigType * Config_Ptr);
 void Timer1_deInit(void);
 
 
-/**********************************************************************************
- * Function Name: TIMER1_Set_CallBack
- * Description  : A Function to set the callBack functions for Timer1 Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
- * RETURNS      : void
- **********************************************************************************/
-void TIMER1_Set_CallBack(void(* ptr_2_fun)(void),uint8 index);
-
-
 #endif /* TIMER1_H_ */
@@ -5,6 +5,7 @@
  * Created on : SEP 4, 2023
  *==========================================================================================*/
 #include "gpio.h"
+#include <avr/interrupt.h>
 
 #ifndef TWI_H_
 #define TWI_H_
@@ -27,6 +28,37 @@ typedef struct
 	TWI_BaudRate bit_rate;
 }TWI_ConfigType;
 
+typedef enum
+{
+	TWI_TRANSFER_IDLE,			/* never submitted */
+	TWI_TRANSFER_PENDING,		/* waiting in the queue */
+	TWI_TRANSFER_BUSY,			/* on the bus now */
+	TWI_TRANSFER_DONE,			/* completed, read buffer is valid */
+	TWI_TRANSFER_FAILED,		/* stopped early, see error */
+	TWI_TRANSFER_TIMEOUT,		/* bus stuck, aborted after TWI_TIMEOUT_MS then recovered */
+}TWI_TransferStatus;
+
+/********************************************************************************
+ * Transaction descriptor, owned by the caller and must stay alive (not a local
+ * of a function that returns) until the status is DONE or FAILED.
+ * The write phase runs first (if write_length != 0) then the read phase
+ * (if read_length != 0), separated by a repeated start if repeated_start is TRUE
+ * or by STOP + START otherwise.
+ * An empty transfer (both lengths 0) only addresses the slave, to probe it.
+ *********************************************************************************/
+typedef struct TWI_Transfer
+{
+	uint8 address;							/* 7-bit slave address */
+	const uint8 *write_buffer;
+	uint8 write_length;
+	uint8 *read_buffer;
+	uint8 read_length;
+	boolean repeated_start;
+	void (*callBack)(struct TWI_Transfer *transfer);	/* called from TWI_vect on completion, may be NULL_PTR */
+	volatile TWI_TransferStatus status;
+	volatile uint8 error;					/* TWSR status that stopped a FAILED transfer */
+}TWI_TransferType;
+
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -40,6 +72,30 @@ typedef struct
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost, another master took the bus. */
+#define TWI_MR_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+#define TWI_NO_INFO       0xF8 /* No relevant state, TWINT is not set */
+#define TWI_BUS_ERROR     0x00 /* Illegal START or STOP condition */
+
+/* a transfer still on the bus after this time is aborted and the bus is recovered */
+#define TWI_TIMEOUT_MS    (10U)
+
+/* TWI_transfer tries a failed transfer again up to this number of times */
+#define TWI_MAX_RETRIES   (2U)
+
+/* TWI pins, driven as GPIO by the bus recovery sequence */
+#define TWI_PORT_ID       PORTC_ID
+#define TWI_SCL_PIN_ID    PIN0_ID
+#define TWI_SDA_PIN_ID    PIN1_ID
+
+/* maximum number of transfers waiting for the bus, must be a power of 2 */
+#define TWI_QUEUE_SIZE    (4U)
+
+#if ((TWI_QUEUE_SIZE & (TWI_QUEUE_SIZE - 1)) != 0)
+#error "TWI_QUEUE_SIZE must be a power of 2"
+#endif
 
 
 /*******************************************************************************
@@ -56,9 +112,58 @@ typedef struct
 void TWI_init(const TWI_ConfigType * Config_Ptr);
 
 
+ /**************************************************************************
+ * Function Name: TWI_submit
+ * Description  : Queue a transfer, the bus is driven from TWI_vect so the
+ *                function returns at once. Interrupts must be enabled.
+ * INPUTS       : transfer (descriptor, must stay alive till it completes)
+ * RETURNS      : boolean (FALSE if the queue is full, transfer is not queued)
+ **************************************************************************/
+boolean TWI_submit(TWI_TransferType *transfer);
+
+
+ /**************************************************************************
+ * Function Name: TWI_transfer
+ * Description  : Queue a transfer and wait for its completion, interrupts
+ *                (UART, timers, ..) are still served while waiting.
+ *                A failed or timed out transfer is tried again up to
+ *                TWI_MAX_RETRIES times.
+ * INPUTS       : transfer (descriptor)
+ * RETURNS      : TWI_TransferStatus (TWI_TRANSFER_DONE, TWI_TRANSFER_FAILED
+ *                or TWI_TRANSFER_TIMEOUT)
+ **************************************************************************/
+TWI_TransferStatus TWI_transfer(TWI_TransferType *transfer);
+
+
+ /**************************************************************************
+ * Function Name: TWI_isBusy
+ * Description  : check if a transfer is on the bus or waiting in the queue,
+ *                a transfer stuck longer than TWI_TIMEOUT_MS is aborted here
+ *                so users of TWI_submit must keep calling it till completion
+ * INPUTS       : void
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean TWI_isBusy(void);
+
+
+ /**************************************************************************
+ * Function Name: TWI_recoverBus
+ * Description  : Free a bus held by a slave: clock SCL up to 9 times till the
+ *                slave releases SDA, then send a STOP by hand and re-enable
+ *                the module. Must only be called while no transfer is running.
+ * INPUTS       : void
+ * RETURNS      : boolean (TRUE if SDA is released)
+ **************************************************************************/
+boolean TWI_recoverBus(void);
+
+
  /**************************************************************************
  * Function Name: TWI_start
  * Description  : (send start condition)
+ *                The polling functions below must not be mixed with queued
+ *                transfers, use them only while TWI_isBusy() is FALSE.
+ *                Their waits are bounded by TWI_TIMEOUT_MS, after a timeout
+ *                TWI_getStatus returns TWI_NO_INFO
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
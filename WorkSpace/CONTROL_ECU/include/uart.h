@@ -8,13 +8,83 @@
 #define UART_H_
 
 #include "gpio.h"
+#include <avr/interrupt.h>
 
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * UART_USE_INTERRUPT : 1 ==> RX/TX are handled by USART_RXC_vect/USART_UDRE_vect through ring buffers
+ *                      0 ==> RX/TX are handled by polling UCSRA flags
+ */
+#define UART_USE_INTERRUPT          (1)
+
+/* Ring buffers sizes, each one must be a power of 2 and not bigger than 128 */
+#define UART_RX_BUFFER_SIZE         (32U)
+#define UART_TX_BUFFER_SIZE         (32U)
+
+#if ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 128)
+#error "UART_RX_BUFFER_SIZE must be a power of 2 and not bigger than 128"
+#endif
+
+#if ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || (UART_TX_BUFFER_SIZE > 128)
+#error "UART_TX_BUFFER_SIZE must be a power of 2 and not bigger than 128"
+#endif
+
+
+/*
+ * Baud rate settings are calculated at compile time for the configured F_CPU,
+ * for each baud rate the mode (normal or U2X) with the smaller error is used.
+ * Error is in units of 0.1% and a profile is supported only if it is within
+ * UART_MAX_BAUD_ERROR and the UBRR value fits in 12 bits
+ */
+#define UART_MAX_BAUD_ERROR          (20UL)    /* 2.0% */
+
+#define UART_UBRR_NORMAL(BAUD)       (((F_CPU) + 8UL * (BAUD)) / (16UL * (BAUD)) - 1UL)
+#define UART_UBRR_U2X(BAUD)          (((F_CPU) + 4UL * (BAUD)) / (8UL * (BAUD)) - 1UL)
+
+#define UART_ACTUAL_NORMAL(BAUD)     ((F_CPU) / (16UL * (UART_UBRR_NORMAL(BAUD) + 1UL)))
+#define UART_ACTUAL_U2X(BAUD)        ((F_CPU) / (8UL * (UART_UBRR_U2X(BAUD) + 1UL)))
+
+#define UART_ERROR(ACTUAL,BAUD)      (((ACTUAL) > (BAUD)) ? ((((ACTUAL) - (BAUD)) * 1000UL) / (BAUD)) \
+                                                          : ((((BAUD) - (ACTUAL)) * 1000UL) / (BAUD)))
+
+#define UART_USE_U2X(BAUD)           (UART_ERROR(UART_ACTUAL_U2X(BAUD),BAUD) < UART_ERROR(UART_ACTUAL_NORMAL(BAUD),BAUD))
+#define UART_UBRR(BAUD)              (UART_USE_U2X(BAUD) ? UART_UBRR_U2X(BAUD) : UART_UBRR_NORMAL(BAUD))
+#define UART_BAUD_ERROR(BAUD)        (UART_USE_U2X(BAUD) ? UART_ERROR(UART_ACTUAL_U2X(BAUD),BAUD) \
+                                                         : UART_ERROR(UART_ACTUAL_NORMAL(BAUD),BAUD))
+#define UART_BAUD_SUPPORTED(BAUD)    ((UART_BAUD_ERROR(BAUD) <= UART_MAX_BAUD_ERROR) && (UART_UBRR(BAUD) <= 4095UL))
+
+/* both ECUs start at this rate, then step up to UART_FASTEST_BAUD_RATE through the handshake */
+#if !UART_BAUD_SUPPORTED(9600UL)
+#error "9600 baud can not be generated within 2% error at this F_CPU"
+#endif
+
+#if UART_BAUD_SUPPORTED(250000UL)
+#define UART_FASTEST_BAUD_RATE       UART_BAUD_250000
+#elif UART_BAUD_SUPPORTED(115200UL)
+#define UART_FASTEST_BAUD_RATE       UART_BAUD_115200
+#elif UART_BAUD_SUPPORTED(38400UL)
+#define UART_FASTEST_BAUD_RATE       UART_BAUD_38400
+#else
+#define UART_FASTEST_BAUD_RATE       UART_BAUD_9600
+#endif
+
 
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
-typedef unsigned long UART_BaudRate;
+/* supported baud rate profiles, used as an index in the compile time UBRR table */
+typedef enum
+{
+	UART_BAUD_9600,
+	UART_BAUD_38400,
+	UART_BAUD_115200,
+	UART_BAUD_250000,
+	UART_BAUD_PROFILES_NUM,
+}UART_BaudRate;
 
 typedef enum
 {
@@ -38,6 +108,20 @@ typedef enum
 	Stop_Two_bit,
 }UART_StopBit;
 
+typedef enum
+{
+	UART_OK,
+	UART_TIMEOUT,
+}UART_StatusType;
+
+typedef struct
+{
+	uint16 overrun_errors;       /* DOR, a byte was lost in hardware */
+	uint16 framing_errors;       /* FE, the byte is dropped */
+	uint16 parity_errors;        /* PE, the byte is dropped */
+	uint16 buffer_overruns;      /* RX ring buffer was full, the byte is dropped */
+}UART_StatsType;
+
 typedef struct
 {
 	UART_BitData bit_data;
@@ -82,6 +166,17 @@ uint8 UART_recieveByte(void);
 
 
 
+/**************************************************************************
+ * Function Name: UART_recieveByteTimeout
+ * Description  : a function to receive a character with a bounded wait,
+ *                the wait is measured with the shared millisecond tick
+ * INPUTS       : data (where the received byte is saved), timeout_ms (max wait)
+ * RETURNS      : UART_StatusType (UART_OK or UART_TIMEOUT, data is untouched on timeout)
+ **************************************************************************/
+UART_StatusType UART_recieveByteTimeout(uint8 *data, uint16 timeout_ms);
+
+
+
 /**************************************************************************
  * Function Name: UART_sendString
  * Description  : a function to send a string as whole packet not a character by character
@@ -100,12 +195,70 @@ void UART_sendString(const uint8* str);
 void UART_receiveString(uint8* str);
 
 
-/**********************************************************************************
- * Function Name: UART_setCallBack
- * Description  : A Function to set the callBack functions for UART Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
+/**************************************************************************
+ * Function Name: UART_write
+ * Description  : Non-blocking write, copies as many bytes as there is room for
+ *                in the TX ring buffer (or as UDR accepts in polling mode)
+ * INPUTS       : data (bytes to be sent), len (number of bytes)
+ * RETURNS      : uint8 (number of bytes actually queued)
+ **************************************************************************/
+uint8 UART_write(const uint8 *data, uint8 len);
+
+
+/**************************************************************************
+ * Function Name: UART_read
+ * Description  : Non-blocking read, takes as many bytes as are already received
+ *                up to len
+ * INPUTS       : data (buffer to save the received bytes in), len (buffer size)
+ * RETURNS      : uint8 (number of bytes actually read)
+ **************************************************************************/
+uint8 UART_read(uint8 *data, uint8 len);
+
+
+/**************************************************************************
+ * Function Name: UART_setBaudRate
+ * Description  : Switch to another baud rate profile, the pending TX bytes
+ *                are sent first with the old rate
+ * INPUTS       : baud_rate (the new profile)
+ * RETURNS      : boolean (FALSE if the profile is not supported at this F_CPU)
+ **************************************************************************/
+boolean UART_setBaudRate(UART_BaudRate baud_rate);
+
+
+/**************************************************************************
+ * Function Name: UART_isBaudRateSupported
+ * Description  : Check if a baud rate profile is within 2% error at this F_CPU
+ * INPUTS       : baud_rate (the profile to be checked)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean UART_isBaudRateSupported(UART_BaudRate baud_rate);
+
+
+/**************************************************************************
+ * Function Name: UART_getSupportedBaudRates
+ * Description  : Get all the profiles supported at this F_CPU, used by the
+ *                link handshake to find the fastest rate both ECUs support
+ * INPUTS       : void
+ * RETURNS      : uint8 (bit n is set if profile n is supported)
+ **************************************************************************/
+uint8 UART_getSupportedBaudRates(void);
+
+
+/**************************************************************************
+ * Function Name: UART_getStats
+ * Description  : Get a consistent copy of the receive error counters
+ * INPUTS       : stats (where the counters are saved)
  * RETURNS      : void
- **********************************************************************************/
-void UART_setCallBack(void (*ptr_2_func)(void),uint8 index);
+ **************************************************************************/
+void UART_getStats(UART_StatsType *stats);
+
+
+/**************************************************************************
+ * Function Name: UART_flush
+ * Description  : Wait until all the queued bytes are completely shifted out
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void UART_flush(void);
 
 #endif /* UART_H_ */
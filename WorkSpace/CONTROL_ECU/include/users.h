@@ -0,0 +1,113 @@
+/*===========================================================================================
+ * Filename   : users.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the multi-user credential table in the external EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef USERS_H_
+#define USERS_H_
+
+#include "std_types.h"
+#include "layout.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the table is in the USERS region of the layout manifest */
+#define USERS_MAX             (32U)
+
+/* Every user has one power-fail safe EEPROM record (two copies, see
+ * EEPROM_writeRecord), user ID n is in record n-1, its DATA is:
+ * | FLAGS | DIGEST (4 bytes, little endian) |
+ * DIGEST is the FNV-1a hash of the PIN, so the PIN itself is never stored.
+ * It only keeps the PIN out of a plain EEPROM dump, it is not a password hash.
+ * A reset while a user is added or revoked leaves the record as it was before.
+ */
+#define USERS_DATA_SIZE       (5U)
+#define USERS_RECORD_SIZE     (EEPROM_RECORD_SIZE(USERS_DATA_SIZE))
+#define USERS_SIZE            (USERS_MAX * USERS_RECORD_SIZE)
+
+/* FLAGS */
+#define USERS_FLAG_ACTIVE     (0x01U)
+#define USERS_FLAG_ADMIN      (0x02U)
+
+/* open addressing index in SRAM, 2 bytes per entry, kept at most half full */
+#define USERS_INDEX_SIZE      (64U)
+
+#if (LAYOUT_ON_CHIP(USERS) != 0) || (USERS_SIZE > LAYOUT_SIZE(USERS))
+#error "the user table needs the external EEPROM (for its records) and must fit in its region"
+#endif
+
+#if ((LAYOUT_PAGE_SIZE(USERS) % EEPROM_RECORD_COPY_SIZE(USERS_DATA_SIZE)) != 0)
+#error "a copy of a user record must never cross an EEPROM page"
+#endif
+
+#if ((USERS_INDEX_SIZE & (USERS_INDEX_SIZE - 1)) != 0) || (USERS_INDEX_SIZE < (2 * USERS_MAX))
+#error "USERS_INDEX_SIZE must be a power of 2 and at least twice USERS_MAX"
+#endif
+
+/* status codes besides the EEPROM ones */
+#define USERS_NOT_FOUND       (6U)	/* no active user with this PIN or ID */
+#define USERS_FULL            (7U)	/* every record is in use */
+#define USERS_DUPLICATE       (8U)	/* another user already has this PIN */
+#define USERS_NOT_LOADED      (9U)	/* USERS_init could not read the whole table */
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: USERS_init
+ * Description  : Read the whole table with a few sequential block reads and
+ *                build the SRAM index of the active users. Till it succeeds
+ *                the users can not be added or revoked
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_init(void);
+
+
+/**************************************************************************
+ * Function Name: USERS_find
+ * Description  : Find the active user of a PIN, the index gives the record
+ *                so it is normally a single block read of one record
+ *                (one more per user whose digest shares the 8-bit tag)
+ * INPUTS       : pin && length, user_id && flags (of the user found)
+ * RETURNS      : uint8 (SUCCESS, USERS_NOT_FOUND or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_find(const uint8 *pin, uint8 length, uint8 *user_id, uint8 *flags);
+
+
+/**************************************************************************
+ * Function Name: USERS_add
+ * Description  : Store a new user in the first free record
+ * INPUTS       : pin && length, flags (USERS_FLAG_ADMIN or 0),
+ *                user_id (ID given to the new user)
+ * RETURNS      : uint8 (SUCCESS, USERS_FULL, USERS_DUPLICATE, USERS_NOT_LOADED
+ *                or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_add(const uint8 *pin, uint8 length, uint8 flags, uint8 *user_id);
+
+
+/**************************************************************************
+ * Function Name: USERS_revoke
+ * Description  : Remove a user, its record is kept but marked not active
+ * INPUTS       : user_id
+ * RETURNS      : uint8 (SUCCESS, USERS_NOT_FOUND, USERS_NOT_LOADED or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_revoke(uint8 user_id);
+
+
+/**************************************************************************
+ * Function Name: USERS_getNext
+ * Description  : Walk the active users in ID order
+ * INPUTS       : user_id (first ID to look at, 1 to start), flags
+ * RETURNS      : uint8 (ID of the next active user, 0 when there is none)
+ **************************************************************************/
+uint8 USERS_getNext(uint8 user_id, uint8 *flags);
+
+
+#endif /* USERS_H_ */
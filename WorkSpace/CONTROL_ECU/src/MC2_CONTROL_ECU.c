@@ -0,0 +1,41 @@
+/*===========================================================================================
+ * Filename   : MC2_CONTROL_ECU.c
+ * Author     : Ahmad Haroun
+ * Description: CONTROL_ECU Source File For DOOR_LOCKER_SYSTEM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+
+/*===========================================================================================
+ * SUMMARY:
+ * CONTROL_ECU serves the requests of HMI_ECU, it keeps the passwords, the users and the
+ * audit log in the EEPROMs and drives the door motor and the buzzer
+ *==========================================================================================*/
+
+/*===========================================================================================
+ * Specification
+ * MicroController    : ATMega32
+ * CPU Frequency      : 8Mhz
+ *********************
+ * Drivers           *
+ *********************
+ * EEPROM             : External EEPROM (24Cxx) over TWI && internal EEPROM
+ * DC MOTOR           : USE TIMER0 PWM
+ * BUZZER             : USE GPIO
+ * TIMER1             : USE TIMER1 (1 ms system tick)
+ * UART               : USE UART
+ *==========================================================================================*/
+#include "app.h"
+#include "scheduler.h"
+
+
+/*******************************************************************************
+ *                               Main                                          *
+ *******************************************************************************/
+int main()
+{
+	APP_init();        /* Initialize the Application */
+
+	APP_start();       /* Serve the requests of HMI_ECU */
+
+	SCHEDULER_run();   /* Event loop, sleeps while there is nothing to do */
+}
@@ -6,15 +6,41 @@
  *==========================================================================================*/
 #include "app.h"
 #include "gpio.h"
-#include <avr/delay.h>
-#include "buzzer.h"
 #include "buzzer.h"
 #include "motor.h"
 #include "external_eeprom.h"
-#include "timer1.h"
+#include "store.h"
+#include "users.h"
+#include "audit.h"
+#include "frame.h"
+#include "tick.h"
+#include "soft_timer.h"
+#include "scheduler.h"
 #include "twi.h"
 #include "uart.h"
 
+#if (PASSWORD_MAX_LENGTH > STORE_MAX_VALUE)
+#error "the password does not fit in a store record"
+#endif
+
+#if (UART_USE_INTERRUPT == 0)
+#error "the requests are served by a task posted from the UART RX interrupt"
+#endif
+
+#if !TICK_IS_REACHABLE(APP_DOOR_MOVE_MS) || !TICK_IS_REACHABLE(APP_DOOR_HOLD_MS) || \
+    !TICK_IS_REACHABLE(APP_LOCKOUT_MS) || !TICK_IS_REACHABLE(AUDIT_FLUSH_MS)
+#error "a delay of the application can not be reached with the tick"
+#endif
+
+#if (FRAME_USER_ADMIN != USERS_FLAG_ADMIN)
+#error "the user flags on the link must match the ones in the user table"
+#endif
+
+#if (FRAME_AUDIT_RECORD_SIZE != AUDIT_RECORD_SIZE) || (USERS_MAX >= AUDIT_NO_USER) || \
+    (FRAME_EVENT_USER_REVOKED > AUDIT_MAX_EVENT)
+#error "the audit records on the link must be the ones of the log"
+#endif
+
 /*******************************************************************************
  *                      Global Variables                                       *
  *******************************************************************************/
@@ -22,8 +48,40 @@
 /* used to indicate the password size, to know how many bytes to read form EEPROM*/
 uint8 pass_size = 0;
 
-/* used to store the required number of ticks of timer1 to generate a certain delay*/
-volatile uint8 ticks = 0;
+/* set once a password is stored, loaded by loadCredential at startup */
+static boolean provisioned = FALSE;
+
+/* the last response sent to HMI_ECU, a retried request is answered from here
+ * instead of being executed twice
+ */
+static FRAME_Type last_response;
+static boolean last_response_valid = FALSE;
+
+/* user ID of the last password verified, the door is opened for this user */
+static uint8 last_user = AUDIT_NO_USER;
+
+/* USERS_FLAG_xxx of that user, the admin commands are served only while it
+ * has USERS_FLAG_ADMIN, it is cleared once the admin session ends
+ */
+static uint8 last_flags = 0;
+
+/* first failure of the storage at startup (SUCCESS if none), reported by
+ * the BOOT event and the provisioning query
+ */
+static uint8 storage_status = SUCCESS;
+
+/* software timers of the door cycle, the lockout buzzer and the audit flush,
+ * they run at the same time on the shared tick
+ */
+static SOFT_TIMER_Type door_timer;
+static SOFT_TIMER_Type buzzer_timer;
+static SOFT_TIMER_Type audit_timer;
+
+/* stage of the door cycle, moved on by the door timer */
+static APP_DoorStateType door_state = DOOR_CLOSED;
+
+/* serves the requests, posted by the UART RX interrupt */
+static SCHEDULER_TaskType receive_task = SCHEDULER_TASK(APP_receive, SCHEDULER_PRIORITY_HIGH);
 
 
 
@@ -34,20 +92,26 @@ volatile uint8 ticks = 0;
 /**************************************************************************
  * Function Name: APP_init
  * Description  : This function is responsible for initializing the peripherals
- *                (TWI && DC MOTOR && UART && BUZZER)
+ *                (TWI && DC MOTOR && UART && BUZZER) and loading the store,
+ *                the user table and the audit log, the first one that fails
+ *                is kept in storage_status
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void APP_init(void)
 {
+	uint8 status;
 
-	UART_ConfigType config =  {Character_8_bit, Parity_Disabled,Stop_One_bit, 9600};
+	UART_ConfigType config =  {Character_8_bit, Parity_Disabled,Stop_One_bit, UART_BAUD_9600};
 
 	TWI_ConfigType TWI_Config = {0x01,400000};
 
 	/* Enable Global Interrupt */
 	SREG |= (1<<7);
 
+	/* shared 1 ms tick for all the delays and timeouts */
+	TICK_init();
+
 	TWI_init(&TWI_Config);
 
 	DcMotor_Init();
@@ -55,42 +119,198 @@ void APP_init(void)
 	UART_init(&config);
 
 	Buzzer_init();
+
+	/* a password set before the reset is still valid, it is kept in SRAM
+	 * so verifyPassword does not touch the bus */
+	storage_status = STORE_mount();
+	STORE_setCachedKey(STORE_KEY_CREDENTIAL);
+	loadCredential();
+
+	/* build the SRAM index of the user table, the users can not be
+	 * added or revoked if it is not fully read */
+	status = USERS_init();
+	if(storage_status == SUCCESS)
+	{
+		storage_status = status;
+	}
+
+	/* find the end of the audit log, every run starts with a BOOT event
+	 * whose result tells if the storage was loaded */
+	status = AUDIT_init();
+	if(storage_status == SUCCESS)
+	{
+		storage_status = status;
+	}
+	AUDIT_log(FRAME_EVENT_BOOT, AUDIT_NO_USER, getStorageResult(storage_status));
 }
 
 
 /**************************************************************************
  * Function Name: APP_start
- * Description  : This function is responsible for Running the system as required
+ * Description  : Start serving the requests of HMI_ECU, every received byte
+ *                posts the receive task, then SCHEDULER_run takes over
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void APP_start(void)
 {
-	/* used to identify the required operation sent by HMI_ECU */
-	uint8 operation_id;
+	/* APP_onReceive is bound to the RX interrupt in isr_hooks.h, this serves
+	 * the bytes received before the scheduler runs */
+	SCHEDULER_post(&receive_task);
+}
+
+
+/**************************************************************************
+ * Function Name: APP_onReceive
+ * Description  : UART RX handler (ISR context, see isr_hooks.h), post the
+ *                receive task
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void APP_onReceive(void)
+{
+	SCHEDULER_post(&receive_task);
+}
 
-	operation_id = UART_recieveByte();
 
-	switch(operation_id)
+/**************************************************************************
+ * Function Name: APP_receive
+ * Description  : Receive task, serve the next complete request (one per
+ *                run, so the timers are served between two requests)
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void APP_receive(void)
+{
+	/* the request frame sent by HMI_ECU, its opcode identifies the required operation */
+	FRAME_Type request;
+
+	/* a partial frame is kept by the parser till the next byte posts the task */
+	if(FRAME_poll(&request) != FRAME_COMPLETE)
 	{
-	case '0':	/* Setting a new password operation */
-		setPassword();
+		return;
+	}
+
+	/* the RX buffer may hold another request already */
+	SCHEDULER_post(&receive_task);
+
+	/* HMI_ECU did not get our last response and sent the same request again */
+	if((last_response_valid == TRUE) && (request.seq == last_response.seq) &&
+	   ((request.opcode | FRAME_OP_RESPONSE) == last_response.opcode))
+	{
+		FRAME_send(last_response.opcode, last_response.seq, last_response.payload, last_response.length);
+		return;
+	}
+
+	/* an admin password opens a session for the admin commands that follow
+	 * it, any other request ends that session (the link speed handshake
+	 * ends it only if HMI_ECU was reset, see setBaudRate) */
+	if((isAdminCommand(request.opcode) == FALSE) && (request.opcode != FRAME_OP_SET_BAUD_RATE))
+	{
+		last_flags = 0;
+	}
+
+	switch(request.opcode)
+	{
+	case FRAME_OP_SET_PASSWORD:	/* Setting a new password operation, an admin command once provisioned */
+		serveAdmin(&request);
 		break;
 
-	case '1':	/* Check if user entered password is correct */
-		verifyPassword();
+	case FRAME_OP_VERIFY_PASSWORD:	/* Check if user entered password is correct */
+		verifyPassword(&request);
 		break;
 
 
-	case'2':	/* open gate operation */
+	case FRAME_OP_OPEN_GATE:	/* open gate operation */
+		APP_sendResponse(&request, FRAME_RESULT_SUCCESS);
+		AUDIT_log(FRAME_EVENT_DOOR_OPENED, last_user, FRAME_RESULT_SUCCESS);
 		openGate();
 		break;
 
 
-	case '3':	/* lock the system */
+	case FRAME_OP_LOCK_SYSTEM:	/* lock the system */
+		APP_sendResponse(&request, FRAME_RESULT_SUCCESS);
+		AUDIT_log(FRAME_EVENT_LOCKOUT, AUDIT_NO_USER, FRAME_RESULT_SUCCESS);
 		lockSystem();
 		break;
+
+	case FRAME_OP_SET_BAUD_RATE:	/* step up the link speed */
+		setBaudRate(&request);
+		break;
+
+	case FRAME_OP_GET_STATS:	/* diagnostics, send the link counters */
+		sendStats(&request);
+		break;
+
+	case FRAME_OP_GET_PROVISIONED:	/* HMI_ECU asks if a password is set */
+		sendProvisioned(&request);
+		break;
+
+	case FRAME_OP_ADD_USER:		/* admin commands on the user table */
+	case FRAME_OP_REVOKE_USER:
+	case FRAME_OP_LIST_USERS:
+	case FRAME_OP_READ_AUDIT:	/* dump of the audit log */
+		serveAdmin(&request);
+		break;
+
+	case FRAME_OP_GET_DOOR_STATE:	/* status poll, served while the door moves */
+		sendDoorState(&request);
+		break;
+
+	case FRAME_OP_ABORT_DOOR:
+		abortDoor(&request);
+		break;
+
+	default:	/* unknown operation, reject it so HMI_ECU does not wait for nothing */
+		APP_sendResponse(&request, FRAME_RESULT_FAIL);
+		break;
+	}
+
+	/* events left in SRAM are written once the link is idle, every request
+	 * pushes the flush back
+	 */
+	if(AUDIT_isPending() == TRUE)
+	{
+		SOFT_TIMER_start(&audit_timer, AUDIT_FLUSH_MS, 0, flushAudit);
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: APP_sendResponse
+ * Description  : Send the response frame of a request to HMI_ECU
+ * INPUTS       : request (the request being answered), result (FRAME_RESULT_xxx)
+ * RETURNS      : void
+ **************************************************************************/
+void APP_sendResponse(const FRAME_Type *request, uint8 result)
+{
+	APP_sendResponseData(request, result, NULL_PTR, 0);
+}
+
+
+/**************************************************************************
+ * Function Name: APP_sendResponseData
+ * Description  : Send the response frame of a request to HMI_ECU with data
+ *                following the result byte
+ * INPUTS       : request (the request being answered), result (FRAME_RESULT_xxx),
+ *                data && length of the data (at most FRAME_MAX_PAYLOAD - 1)
+ * RETURNS      : void
+ **************************************************************************/
+void APP_sendResponseData(const FRAME_Type *request, uint8 result, const uint8 *data, uint8 length)
+{
+	uint8 i;
+
+	last_response.opcode = request->opcode | FRAME_OP_RESPONSE;
+	last_response.seq = request->seq;
+	last_response.length = length + 1;
+	last_response.payload[0] = result;
+	for(i = 0; i < length; i++)
+	{
+		last_response.payload[i + 1] = data[i];
 	}
+	last_response_valid = TRUE;
+
+	FRAME_send(last_response.opcode, last_response.seq, last_response.payload, last_response.length);
 }
 
 
@@ -98,212 +318,567 @@ void APP_start(void)
  * Function Name: setPassword
  * Description  : This function is responsible for setting and updating
  *                the password of the system
+ * INPUTS       : request (frame holding the new password as payload)
+ * RETURNS      : uint8 (FRAME_RESULT_xxx sent to HMI_ECU)
+ **************************************************************************/
+uint8 setPassword(const FRAME_Type *request)
+{
+	uint8 result = FRAME_RESULT_FAIL;
+
+	if(request->length <= PASSWORD_MAX_LENGTH)
+	{
+		/* append the new password to the store, the old one stays valid till it is fully written */
+		if(STORE_write(STORE_KEY_CREDENTIAL, request->payload, request->length) == SUCCESS)
+		{
+			pass_size = request->length;
+			provisioned = TRUE;
+			result = FRAME_RESULT_SUCCESS;
+		}
+		else
+		{
+			result = FRAME_RESULT_STORAGE_ERROR;
+		}
+	}
+
+	APP_sendResponse(request, result);
+	AUDIT_log(FRAME_EVENT_PASSWORD_SET, last_user, result);
+
+	return result;
+}
+
+
+/**************************************************************************
+ * Function Name: loadCredential
+ * Description  : Read the credential record from the store, if there is a
+ *                valid one the system is provisioned
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void setPassword(void)
+void loadCredential(void)
 {
-	uint8 received_pass[10] = "";
+	uint8 stored_pass[STORE_MAX_VALUE];
+
+	provisioned = ((STORE_read(STORE_KEY_CREDENTIAL, stored_pass, &pass_size) == SUCCESS) &&
+	               (pass_size <= PASSWORD_MAX_LENGTH));
+
+	if(provisioned == FALSE)
+	{
+		pass_size = 0;
+	}
+}
+
 
+/**************************************************************************
+ * Function Name: sendProvisioned
+ * Description  : Tell HMI_ECU if a password is already set, or that the
+ *                storage could not be loaded at startup
+ * INPUTS       : request (the provisioning query)
+ * RETURNS      : void
+ **************************************************************************/
+void sendProvisioned(const FRAME_Type *request)
+{
+	if(provisioned == TRUE)
+	{
+		APP_sendResponse(request, FRAME_RESULT_SUCCESS);
+	}
+	else
+	{
+		/* no password, or none could be read */
+		APP_sendResponse(request, (storage_status == SUCCESS) ? FRAME_RESULT_FAIL : FRAME_RESULT_STORAGE_ERROR);
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: setBaudRate
+ * Description  : Handle the link speed handshake, choose the fastest profile
+ *                supported by both ECUs, reply with it then switch to it
+ * INPUTS       : request (frame holding the HMI_ECU supported profiles bitmask)
+ * RETURNS      : void
+ **************************************************************************/
+void setBaudRate(const FRAME_Type *request)
+{
+	uint8 response[2];
+	uint8 common;
+	sint8 baud_rate;
+
+	/* HMI_ECU probes with this request after a reset or a timeout. Only after
+	 * its reset do its SEQ numbers start over, after a timeout it sends the
+	 * same request again and the last response must still answer it */
+	if((request->length < 2) || (request->payload[1] != FRAME_SESSION_RESUMED))
+	{
+		last_response_valid = FALSE;
+		last_flags = 0;
+	}
+
+	common = UART_getSupportedBaudRates();
+	if(request->length != 0)
+	{
+		common &= request->payload[0];
+	}
+
+	/* pick the fastest common profile, 9600 is always supported by both */
+	for(baud_rate = UART_BAUD_PROFILES_NUM - 1; baud_rate > UART_BAUD_9600; baud_rate--)
+	{
+		if(common & (1 << baud_rate))
+		{
+			break;
+		}
+	}
+
+	response[0] = FRAME_RESULT_SUCCESS;
+	response[1] = (uint8)baud_rate;
+	FRAME_send(request->opcode | FRAME_OP_RESPONSE, request->seq, response, 2);
+
+	/* the response goes out with the old rate, UART_setBaudRate waits for it */
+	UART_setBaudRate((UART_BaudRate)baud_rate);
+}
+
+
+/**************************************************************************
+ * Function Name: sendStats
+ * Description  : Diagnostics command, send the link statistics of this ECU
+ * INPUTS       : request (the diagnostics request)
+ * RETURNS      : void
+ **************************************************************************/
+void sendStats(const FRAME_Type *request)
+{
+	uint16 stats[FRAME_STATS_NUM];
+	uint8 data[FRAME_STATS_NUM * 2];
 	uint8 i;
-	/* reset pass_size , i */
-	pass_size = 0;
-	i = 0;
 
-	/* store the user entered password */
-	UART_receiveString(received_pass);
+	FRAME_getStats(stats);
 
-	/* store password in eeprom */
-	while(received_pass[i])
+	/* little endian, in FRAME_StatIndex order */
+	for(i = 0; i < FRAME_STATS_NUM; i++)
 	{
-		EEPROM_writeByte(EEPROM_PASSWORD_LOCATION+i,received_pass[i]);
-		_delay_ms(10);
-		pass_size++;
-		i++;
+		data[2 * i] = (uint8)stats[i];
+		data[(2 * i) + 1] = (uint8)(stats[i] >> 8);
 	}
+
+	APP_sendResponseData(request, FRAME_RESULT_SUCCESS, data, sizeof(data));
 }
 
 
 /**************************************************************************
  * Function Name: verifyPassword
  * Description  : The function is to check if the passed two passwords are identical
- * INPUTS       : void
+ * INPUTS       : request (frame holding the user entered password as payload)
  * RETURNS      : void
  **************************************************************************/
-void verifyPassword(void)
+void verifyPassword(const FRAME_Type *request)
 {
-	/* isMathed is a flag that is set when password is correct,
-	 * i is a counter used when reading from EEPROM
-	 */
-	uint8 i;
-	boolean isMatched;
-	uint8 received_pass[10] = "";
+	/* isMathed is a flag that is set when password is correct */
+	boolean isMatched = FALSE;
+	uint8 stored_size;
+	uint8 status;
 
+	uint8 stored_pass[STORE_MAX_VALUE]; /* to store the password extracted from the store */
+	uint8 user[2] = {0, FRAME_USER_ADMIN}; /* ID && flags of the matched user, the system password first */
 
-	uint8 stored_pass[10] = ""; /* to store the password extracted from EEPROM */
-
+	if(provisioned == TRUE)
+	{
+		/* extract saved password (from SRAM, EEPROM only if the copy is stale),
+		 * never accept a password that could not be read */
+		if((STORE_read(STORE_KEY_CREDENTIAL, stored_pass, &stored_size) != SUCCESS) || (stored_size != pass_size))
+		{
+			last_user = AUDIT_NO_USER;
+			APP_sendResponse(request, FRAME_RESULT_STORAGE_ERROR);
+			AUDIT_log(FRAME_EVENT_ACCESS_DENIED, AUDIT_NO_USER, FRAME_RESULT_STORAGE_ERROR);
+			return;
+		}
 
-	/* store the user entered password */
-	UART_receiveString(received_pass);
+		/* check if the user entered password && stored password are identical */
+		if(request->length == pass_size)
+		{
+			isMatched = isPassMatched(request->payload, stored_pass, pass_size);
+		}
+	}
 
-	/* extract saved password from EEPROM */
-	for(i = 0; i < pass_size; i++)
+	/* then the PINs of the user table */
+	if(isMatched == FALSE)
 	{
-		EEPROM_readByte(EEPROM_PASSWORD_LOCATION + i, &stored_pass[i]);
-		_delay_ms(10);
+		status = USERS_find(request->payload, request->length, &user[0], &user[1]);
+		if(status == SUCCESS)
+		{
+			isMatched = TRUE;
+		}
+		else if(status != USERS_NOT_FOUND)
+		{
+			last_user = AUDIT_NO_USER;
+			APP_sendResponse(request, FRAME_RESULT_STORAGE_ERROR);
+			AUDIT_log(FRAME_EVENT_ACCESS_DENIED, AUDIT_NO_USER, FRAME_RESULT_STORAGE_ERROR);
+			return;
+		}
 	}
 
-	/* check if the user entered password && stored password are identical */
-	isMatched = isPassMatched(received_pass, stored_pass, pass_size);
 	if(isMatched == TRUE)
 	{
-		/* if matched, send '1' */
-		UART_sendByte('1');
+		APP_sendResponseData(request, FRAME_RESULT_SUCCESS, user, 2);
+		last_user = user[0];
+		last_flags = user[1];
+		AUDIT_log(FRAME_EVENT_ACCESS_GRANTED, last_user, FRAME_RESULT_SUCCESS);
 	}
 	else
 	{
-		/* if not matched, send '0' */
-		UART_sendByte('0');
+		APP_sendResponse(request, FRAME_RESULT_FAIL);
+		last_user = AUDIT_NO_USER;
+		AUDIT_log(FRAME_EVENT_ACCESS_DENIED, AUDIT_NO_USER, FRAME_RESULT_FAIL);
 	}
 
 }
 
 
 /**************************************************************************
- * Function Name: isPassMatched
- * Description  : This function is to compare user entered password && system password
- * INPUTS       : void
- * RETURNS      : uint8
- * 			      TRUE  ==> Passwords match
- * 			      FALSE ==> Passwords do not match
+ * Function Name: getStorageResult
+ * Description  : Turn a storage status into the result byte of a response
+ * INPUTS       : status (SUCCESS, a refused request or an EEPROM failure)
+ * RETURNS      : uint8 (FRAME_RESULT_xxx)
  **************************************************************************/
-uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size)
+uint8 getStorageResult(uint8 status)
 {
-	uint8 i ;
-	boolean matched = TRUE;
-	for(i = 0; i < size; ++i)
+	switch(status)
 	{
-		if(pass1[i] != pass2[i])
+	case SUCCESS:
+		return FRAME_RESULT_SUCCESS;
+
+	case USERS_NOT_FOUND:
+	case USERS_FULL:
+	case USERS_DUPLICATE:
+		return FRAME_RESULT_FAIL;
+
+	/* USERS_NOT_LOADED and the EEPROM failures */
+	default:
+		return FRAME_RESULT_STORAGE_ERROR;
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: isAdminCommand
+ * Description  : Tell if a request is served only after the password of an admin
+ * INPUTS       : opcode (FRAME_OP_xxx)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean isAdminCommand(uint8 opcode)
+{
+	return ((opcode == FRAME_OP_SET_PASSWORD) || (opcode == FRAME_OP_ADD_USER) ||
+	        (opcode == FRAME_OP_REVOKE_USER) || (opcode == FRAME_OP_LIST_USERS) ||
+	        (opcode == FRAME_OP_READ_AUDIT));
+}
+
+
+/**************************************************************************
+ * Function Name: serveAdmin
+ * Description  : Serve an admin command, only after the password of an admin
+ *                (the first password is set without one). Setting the
+ *                password, adding or revoking a user ends the admin session,
+ *                the list and the audit dump go on for their next pages
+ * INPUTS       : request (the admin command)
+ * RETURNS      : void
+ **************************************************************************/
+void serveAdmin(const FRAME_Type *request)
+{
+	if(((last_flags & USERS_FLAG_ADMIN) == 0) &&
+	   ((request->opcode != FRAME_OP_SET_PASSWORD) || (provisioned == TRUE)))
+	{
+		APP_sendResponse(request, FRAME_RESULT_FAIL);
+		return;
+	}
+
+	switch(request->opcode)
+	{
+	case FRAME_OP_SET_PASSWORD:
+		/* a password that could not be saved can be sent again */
+		if(setPassword(request) == FRAME_RESULT_SUCCESS)
 		{
-			matched = FALSE;
-			break;
+			last_flags = 0;
 		}
+		break;
+
+	case FRAME_OP_ADD_USER:
+		addUser(request);
+		last_flags = 0;
+		break;
+
+	case FRAME_OP_REVOKE_USER:
+		revokeUser(request);
+		last_flags = 0;
+		break;
+
+	case FRAME_OP_LIST_USERS:
+		listUsers(request);
+		break;
+
+	default:
+		sendAudit(request);
+		break;
 	}
+}
 
-	return matched;
+
+/**************************************************************************
+ * Function Name: addUser
+ * Description  : Admin command, add a user to the user table
+ * INPUTS       : request (frame holding the user flags then the PIN)
+ * RETURNS      : void
+ **************************************************************************/
+void addUser(const FRAME_Type *request)
+{
+	uint8 user_id = 0;
+	uint8 status;
+
+	if((request->length < 2) || ((request->length - 1) > PASSWORD_MAX_LENGTH))
+	{
+		APP_sendResponse(request, FRAME_RESULT_FAIL);
+		return;
+	}
+
+	status = USERS_add(&request->payload[1], request->length - 1, request->payload[0], &user_id);
+
+	APP_sendResponseData(request, getStorageResult(status), &user_id, 1);
+	AUDIT_log(FRAME_EVENT_USER_ADDED, (status == SUCCESS) ? user_id : AUDIT_NO_USER, getStorageResult(status));
 }
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_15sec
- * Description  : This function is to generate 15 seconds delay using timer1.
- * INPUTS       : void
+ * Function Name: revokeUser
+ * Description  : Admin command, remove a user from the user table
+ * INPUTS       : request (frame holding the user ID)
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_15sec(void)
+void revokeUser(const FRAME_Type *request)
 {
-	/* Timer operates in CTC mode, required OCR value to generate 15 seconds
-	 * at 1024 pre-scaler is 58594 for 2 times,
-	 * for TCNT1 element is configuration can be any dummy number'1000'*/
-	Timer1_ConfigType config = { 0 , 58594, TIMER1_PRESCALER_1024, Timer1_CTC_Mode};
-	Timer1_init(&config);
+	uint8 result;
+
+	if(request->length != 1)
+	{
+		APP_sendResponse(request, FRAME_RESULT_FAIL);
+		return;
+	}
 
-	TIMER1_Set_CallBack(TIMER1_callback_function,1);
+	result = getStorageResult(USERS_revoke(request->payload[0]));
 
-	while(ticks < 2);
+	APP_sendResponse(request, result);
+	AUDIT_log(FRAME_EVENT_USER_REVOKED, request->payload[0], result);
+}
 
-	ticks = 0;
 
-	Timer1_deInit();
+/**************************************************************************
+ * Function Name: listUsers
+ * Description  : Admin command, send the active users starting at an ID,
+ *                as many as fit in one response
+ * INPUTS       : request (frame holding the first user ID)
+ * RETURNS      : void
+ **************************************************************************/
+void listUsers(const FRAME_Type *request)
+{
+	uint8 data[FRAME_MAX_PAYLOAD - 1];
+	uint8 length = 1;
+	uint8 flags;
+	uint8 user_id = (request->length != 0) ? request->payload[0] : 1;
+
+	/* data[0] is the ID to ask for next, 0 once every user is sent */
+	user_id = USERS_getNext(user_id, &flags);
+	while((user_id != 0) && ((uint8)(length + 2) <= sizeof(data)))
+	{
+		data[length] = user_id;
+		data[length + 1] = flags;
+		length += 2;
+		user_id = USERS_getNext(user_id + 1, &flags);
+	}
+	data[0] = user_id;
+
+	APP_sendResponseData(request, FRAME_RESULT_SUCCESS, data, length);
 }
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_3sec
- * Description  : This function is to generate 3 seconds delay using timer1.
- * INPUTS       : void
+ * Function Name: sendAudit
+ * Description  : Dump of the audit log, send the records of the events from
+ *                a SEQ on, as many as fit in one response
+ * INPUTS       : request (frame holding the first SEQ, none for the oldest event)
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_3sec(void)
+void sendAudit(const FRAME_Type *request)
 {
-	/* (3_SEC) == 23436 timer counts */
-	/* Timer operates in CTC mode, required OCR value to generate 3 seconds
-	 * at 1024 pre-scaler is 23450,
-	 * for TCNT1 element is configuration can be any number*/
-	Timer1_ConfigType config = {0,23436, TIMER1_PRESCALER_1024, Timer1_CTC_Mode};
-	Timer1_init(&config);
+	uint8 data[FRAME_MAX_PAYLOAD - 1];
+	uint8 count = (sizeof(data) - 2) / AUDIT_RECORD_SIZE;
+	uint16 seq;
 
-	/* set callback function for timer1 interrupt */
-	TIMER1_Set_CallBack(TIMER1_callback_function,1);
+	seq = (request->length == 2) ? (request->payload[0] | ((uint16)request->payload[1] << 8)) : AUDIT_getOldest();
 
-	/* wait for timer interrupt */
-	while(ticks == 0);
+	if(AUDIT_read(&seq, &data[2], &count) != SUCCESS)
+	{
+		APP_sendResponse(request, FRAME_RESULT_STORAGE_ERROR);
+		return;
+	}
 
-	/* reset ticks variable for next future use */
-	ticks = 0;
+	/* data[0..1] is the SEQ to ask for next */
+	seq += count;
+	data[0] = (uint8)seq;
+	data[1] = (uint8)(seq >> 8);
 
-	Timer1_deInit();
+	APP_sendResponseData(request, FRAME_RESULT_SUCCESS, data, 2 + (count * AUDIT_RECORD_SIZE));
 }
 
 
 /**************************************************************************
- * Function Name: TIMER1_callback_function
- * Description  : The required function to be executed when timer interrupt
- *                is fired, "increments ticks variable"
+ * Function Name: isPassMatched
+ * Description  : This function is to compare user entered password && system password
  * INPUTS       : void
- * RETURNS      : void
+ * RETURNS      : uint8
+ * 			      TRUE  ==> Passwords match
+ * 			      FALSE ==> Passwords do not match
  **************************************************************************/
-void TIMER1_callback_function(void)
+uint8 isPassMatched(const uint8 * pass1, const uint8 * pass2, uint8 size)
 {
-	ticks++;
+	uint8 i ;
+	boolean matched = TRUE;
+	for(i = 0; i < size; ++i)
+	{
+		if(pass1[i] != pass2[i])
+		{
+			matched = FALSE;
+			break;
+		}
+	}
+
+	return matched;
 }
 
 
+/**************************************************************************
+ * Function Name: flushAudit
+ * Description  : Callback of the audit timer, write the events left in SRAM
+ *                once the link has been idle for AUDIT_FLUSH_MS
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void flushAudit(void)
+{
+	AUDIT_flush();
+}
+
 
 /**************************************************************************
  * Function Name: lockSystem
  * Description  : This function is responsible for locking the system
- *                In case of password entered is wrong for 3 times
+ *                In case of password entered is wrong for 3 times,
+ *                the buzzer timer turns the buzzer off
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void lockSystem(void)
 {
 	/* The control ECU is required to turn on the buzzer for 1 minute when system
-	 * goes to the locked state
+	 * goes to the locked state, a new lockout restarts the minute
 	 */
-	uint8 timer_counter;	/* used to repeat the 15sec delay function to get 1 minute */
-
-	/* turn on buzzer for 1 minute */
 	Buzzer_on();
-	for(timer_counter = 0; timer_counter < 4; timer_counter++)
-	{
-		TIMER1_delay_15sec();
-	}
-	Buzzer_off();
+	SOFT_TIMER_start(&buzzer_timer, APP_LOCKOUT_MS, 0, Buzzer_off);
 }
 
 
 /**************************************************************************
  * Function Name: openGate
- * Description  : This function is responsible to open the door
+ * Description  : Start the door cycle, it goes on in the background (door
+ *                timer) so requests are still served while the door moves
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void openGate(void)
 {
+	/* the door is already moving, its cycle goes on */
+	if(door_state != DOOR_CLOSED)
+	{
+		return;
+	}
+
 	/* open the door by rotating the DC motor CW for 15 seconds */
 	DcMotor_Rotate(rotate_CW,100);
-	TIMER1_delay_15sec();
+	door_state = DOOR_OPENING;
+	SOFT_TIMER_start(&door_timer, APP_DOOR_MOVE_MS, 0, stepDoor);
+}
 
-	/* keep the door open for 3 seconds */
-	DcMotor_Rotate(stop,100);
-	TIMER1_delay_3sec();
 
-	/* lock the door by rotating the DC motor ACW for 15 seconds */
+/**************************************************************************
+ * Function Name: sendDoorState
+ * Description  : Status poll, send the stage of the door cycle and the
+ *                seconds left before the next one
+ * INPUTS       : request (the status request)
+ * RETURNS      : void
+ **************************************************************************/
+void sendDoorState(const FRAME_Type *request)
+{
+	uint8 data[2];
+
+	data[0] = (uint8)door_state;
+	data[1] = (uint8)((SOFT_TIMER_getRemaining(&door_timer) + 999UL) / 1000UL);
+
+	APP_sendResponseData(request, FRAME_RESULT_SUCCESS, data, 2);
+}
+
+
+/**************************************************************************
+ * Function Name: abortDoor
+ * Description  : Stop the door cycle, an opening door closes back for as
+ *                long as it has been opening, an open door closes at once
+ * INPUTS       : request (the abort request)
+ * RETURNS      : void
+ **************************************************************************/
+void abortDoor(const FRAME_Type *request)
+{
+	uint32 closing_ms;
+
+	switch(door_state)
+	{
+	case DOOR_OPENING:
+		closing_ms = APP_DOOR_MOVE_MS - SOFT_TIMER_getRemaining(&door_timer);
+		break;
+
+	case DOOR_HOLDING:
+		closing_ms = APP_DOOR_MOVE_MS;
+		break;
+
+	default:	/* closed or closing already */
+		APP_sendResponse(request, FRAME_RESULT_FAIL);
+		return;
+	}
+
 	DcMotor_Rotate(rotate_A_CW,100);
-	TIMER1_delay_15sec();
+	door_state = DOOR_CLOSING;
+	SOFT_TIMER_start(&door_timer, closing_ms, 0, stepDoor);
+
+	APP_sendResponse(request, FRAME_RESULT_SUCCESS);
+}
+
+
+/**************************************************************************
+ * Function Name: stepDoor
+ * Description  : Callback of the door timer, move the door to the next
+ *                stage of its cycle
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void stepDoor(void)
+{
+	switch(door_state)
+	{
+	case DOOR_OPENING:	/* keep the door open for 3 seconds */
+		DcMotor_Rotate(stop,100);
+		door_state = DOOR_HOLDING;
+		SOFT_TIMER_start(&door_timer, APP_DOOR_HOLD_MS, 0, stepDoor);
+		break;
 
-	/* stop the motor */
-	DcMotor_Rotate(stop,100);
+	case DOOR_HOLDING:	/* lock the door by rotating the DC motor ACW for 15 seconds */
+		DcMotor_Rotate(rotate_A_CW,100);
+		door_state = DOOR_CLOSING;
+		SOFT_TIMER_start(&door_timer, APP_DOOR_MOVE_MS, 0, stepDoor);
+		break;
+
+	default:	/* stop the motor, the door is closed */
+		DcMotor_Rotate(stop,100);
+		door_state = DOOR_CLOSED;
+		break;
+	}
 }
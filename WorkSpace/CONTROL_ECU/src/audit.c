@@ -0,0 +1,792 @@
+/*===========================================================================================
+ * Filename   : audit.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the audit event log ring in the external EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "audit.h"
+#include "frame.h"
+#include "crc16.h"
+#include "tick.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* offsets in a block */
+#define AUDIT_SEQ_OFFSET      (0U)
+#define AUDIT_TIME_OFFSET     (2U)
+#define AUDIT_HEADER_SIZE     (5U)
+#define AUDIT_USED_OFFSET     (AUDIT_BLOCK_SIZE - 3U)
+#define AUDIT_CRC_OFFSET      (AUDIT_BLOCK_SIZE - 2U)
+
+/* fields of the first byte of a record */
+#define AUDIT_EVENT_SHIFT     (5U)
+#define AUDIT_NEW_USER        (0x10U)
+#define AUDIT_NEW_RESULT      (0x08U)
+#define AUDIT_DELTA_MASK      (0x07U)
+#define AUDIT_DELTA_VARINT    (0x06U)
+#define AUDIT_DELTA_INVALID   (0x07U)
+
+/* longest record: first byte, USER_ID, RESULT and a 24-bit delta in 4 varint bytes */
+#define AUDIT_MAX_RECORD      (7U)
+
+/* TIME and the times of the records are 24-bit */
+#define AUDIT_TIME_MASK       (0x00FFFFFFUL)
+
+/* AUDIT_ReadIndex when no block is kept */
+#define AUDIT_NO_BLOCK        (0xFFU)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* position in the records of a block, with the fields the next record is relative to */
+typedef struct
+{
+	uint8 position;			/* first byte of the next record */
+	uint8 end;				/* USED of the block */
+	uint32 time;
+	uint8 user_id;			/* of the last event tied to a user */
+}AUDIT_CursorType;
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* the open block, the newest one */
+static uint8 AUDIT_Block[AUDIT_BLOCK_SIZE];
+static boolean AUDIT_Open = FALSE;
+static uint8 AUDIT_Used = 0;		/* end of its records */
+static uint8 AUDIT_Written = 0;		/* bytes of it already in the EEPROM */
+static uint32 AUDIT_Time = 0;		/* time of its last record */
+static uint8 AUDIT_User = AUDIT_NO_USER;	/* USER_ID of its last event tied to a user */
+
+/* blocks in use are the run from the oldest to the newest one */
+static boolean AUDIT_Empty = TRUE;
+static uint8 AUDIT_Oldest = 0;
+static uint8 AUDIT_Newest = 0;
+static uint16 AUDIT_BlockSeq[AUDIT_BLOCKS];		/* SEQ of every block in use */
+
+/* SEQ of the next event */
+static uint16 AUDIT_Seq = 0;
+
+/* the last block read by AUDIT_read, so the next calls do not read it again */
+static uint8 AUDIT_ReadBuffer[AUDIT_BLOCK_SIZE];
+static uint8 AUDIT_ReadIndex = AUDIT_NO_BLOCK;
+static uint8 AUDIT_ReadUsed = 0;	/* 0 if it failed its CRC */
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: AUDIT_offset
+ * Description  : Offset of a block in the AUDIT region
+ * INPUTS       : index (block number)
+ * RETURNS      : uint16
+ **************************************************************************/
+static uint16 AUDIT_offset(uint8 index)
+{
+	return (uint16)index * AUDIT_BLOCK_SIZE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_startCursor
+ * Description  : Point a cursor at the first record of a block
+ * INPUTS       : block, end (USED of the block), cursor
+ * RETURNS      : void
+ **************************************************************************/
+static void AUDIT_startCursor(const uint8 *block, uint8 end, AUDIT_CursorType *cursor)
+{
+	cursor->position = AUDIT_HEADER_SIZE;
+	cursor->end = end;
+	cursor->time = block[AUDIT_TIME_OFFSET] | ((uint32)block[AUDIT_TIME_OFFSET + 1] << 8) |
+	               ((uint32)block[AUDIT_TIME_OFFSET + 2] << 16);
+	cursor->user_id = AUDIT_NO_USER;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_usualResult
+ * Description  : Result most events of a kind have, it is not stored
+ * INPUTS       : event
+ * RETURNS      : uint8 (FRAME_RESULT_xxx)
+ **************************************************************************/
+static uint8 AUDIT_usualResult(uint8 event)
+{
+	return (event == FRAME_EVENT_ACCESS_DENIED) ? FRAME_RESULT_FAIL : FRAME_RESULT_SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_usualUser
+ * Description  : USER_ID most events of a kind have, it is not stored. The
+ *                events that are not tied to a user have none, the others
+ *                usually have the user of the last one tied to a user
+ * INPUTS       : event, last_user (of the last event tied to a user)
+ * RETURNS      : uint8
+ **************************************************************************/
+static uint8 AUDIT_usualUser(uint8 event, uint8 last_user)
+{
+	if((event == FRAME_EVENT_BOOT) || (event == FRAME_EVENT_ACCESS_DENIED) || (event == FRAME_EVENT_LOCKOUT))
+	{
+		return AUDIT_NO_USER;
+	}
+
+	return last_user;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_decode
+ * Description  : Decode the record at the cursor and move the cursor after it
+ * INPUTS       : block, cursor, event && user_id && result (of the record)
+ * RETURNS      : boolean (FALSE at the end of the records)
+ **************************************************************************/
+static boolean AUDIT_decode(const uint8 *block, AUDIT_CursorType *cursor, uint8 *event, uint8 *user_id, uint8 *result)
+{
+	uint8 first;
+	uint8 byte;
+	uint8 shift = 0;
+	uint32 delta;
+
+	if(cursor->position >= cursor->end)
+	{
+		return FALSE;
+	}
+
+	first = block[cursor->position];
+	if((first & AUDIT_DELTA_MASK) == AUDIT_DELTA_INVALID)
+	{
+		/* padding */
+		return FALSE;
+	}
+	cursor->position++;
+
+	*event = first >> AUDIT_EVENT_SHIFT;
+	*user_id = AUDIT_usualUser(*event, cursor->user_id);
+	*result = AUDIT_usualResult(*event);
+
+	if(first & AUDIT_NEW_USER)
+	{
+		if(cursor->position >= cursor->end)
+		{
+			return FALSE;
+		}
+		*user_id = block[cursor->position++];
+	}
+
+	if(first & AUDIT_NEW_RESULT)
+	{
+		if(cursor->position >= cursor->end)
+		{
+			return FALSE;
+		}
+		*result = block[cursor->position++];
+	}
+
+	delta = first & AUDIT_DELTA_MASK;
+	if(delta == AUDIT_DELTA_VARINT)
+	{
+		delta = 0;
+		do
+		{
+			if((cursor->position >= cursor->end) || (shift > 21))
+			{
+				return FALSE;
+			}
+			byte = block[cursor->position++];
+			delta |= (uint32)(byte & 0x7F) << shift;
+			shift += 7;
+		}while(byte & 0x80);
+	}
+
+	/* the BOOT event gives the time again, it starts from 0 at a reset */
+	if(*event == FRAME_EVENT_BOOT)
+	{
+		cursor->time = delta & AUDIT_TIME_MASK;
+	}
+	else
+	{
+		cursor->time = (cursor->time + delta) & AUDIT_TIME_MASK;
+	}
+
+	if(AUDIT_usualUser(*event, *user_id) != AUDIT_NO_USER)
+	{
+		cursor->user_id = *user_id;
+	}
+
+	return TRUE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_encode
+ * Description  : Encode an event relative to the last record of the open block
+ * INPUTS       : record (AUDIT_MAX_RECORD bytes), event, user_id, result, time
+ * RETURNS      : uint8 (length of the record)
+ **************************************************************************/
+static uint8 AUDIT_encode(uint8 *record, uint8 event, uint8 user_id, uint8 result, uint32 time)
+{
+	uint32 delta = (event == FRAME_EVENT_BOOT) ? (time & AUDIT_TIME_MASK) : ((time - AUDIT_Time) & AUDIT_TIME_MASK);
+	uint8 length = 1;
+
+	record[0] = event << AUDIT_EVENT_SHIFT;
+
+	if(user_id != AUDIT_usualUser(event, AUDIT_User))
+	{
+		record[0] |= AUDIT_NEW_USER;
+		record[length++] = user_id;
+	}
+
+	if(result != AUDIT_usualResult(event))
+	{
+		record[0] |= AUDIT_NEW_RESULT;
+		record[length++] = result;
+	}
+
+	if(delta < AUDIT_DELTA_VARINT)
+	{
+		record[0] |= (uint8)delta;
+	}
+	else
+	{
+		record[0] |= AUDIT_DELTA_VARINT;
+		do
+		{
+			record[length] = (uint8)(delta & 0x7F);
+			delta >>= 7;
+			if(delta != 0)
+			{
+				record[length] |= 0x80;
+			}
+			length++;
+		}while(delta != 0);
+	}
+
+	return length;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_write
+ * Description  : Write a range of the open block to the EEPROM
+ * INPUTS       : start && end (offsets in the block)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 AUDIT_write(uint8 start, uint8 end)
+{
+	if(start >= end)
+	{
+		return SUCCESS;
+	}
+
+	/* split on the pages, one write cycle per page */
+	return LAYOUT_write(AUDIT, AUDIT_offset(AUDIT_Newest) + start, &AUDIT_Block[start], end - start);
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_seal
+ * Description  : Write the records left in SRAM and the trailer (USED and
+ *                CRC) of the open block, it is closed
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 AUDIT_seal(void)
+{
+	uint16 crc;
+	uint8 start = AUDIT_Written;
+	uint8 status;
+
+	AUDIT_Block[AUDIT_USED_OFFSET] = AUDIT_Used;
+	crc = CRC16_update(CRC16_compute(AUDIT_Block, AUDIT_Used), AUDIT_Used);
+	AUDIT_Block[AUDIT_CRC_OFFSET] = (uint8)crc;
+	AUDIT_Block[AUDIT_CRC_OFFSET + 1] = (uint8)(crc >> 8);
+
+	/* records that reach the last page go with the trailer in the same writes,
+	 * the padding is already erased so it is simply written again */
+	if(AUDIT_Used <= (AUDIT_USED_OFFSET - (AUDIT_USED_OFFSET % AUDIT_PAGE_SIZE)))
+	{
+		status = AUDIT_write(start, AUDIT_Used);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+		start = AUDIT_USED_OFFSET;
+	}
+
+	status = AUDIT_write(start, AUDIT_BLOCK_SIZE);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	AUDIT_Written = AUDIT_BLOCK_SIZE;
+	AUDIT_Open = FALSE;
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_openBlock
+ * Description  : Erase the block after the newest one and make it the open
+ *                block, the oldest block is overwritten once the ring is full
+ * INPUTS       : time (of the first event)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 AUDIT_openBlock(uint32 time)
+{
+	uint8 index = (AUDIT_Empty == TRUE) ? 0 : ((AUDIT_Newest + 1) % AUDIT_BLOCKS);
+	uint8 status;
+	uint8 i;
+
+	for(i = 0; i < AUDIT_BLOCK_SIZE; i++)
+	{
+		AUDIT_Block[i] = 0xFF;
+	}
+	AUDIT_Block[AUDIT_SEQ_OFFSET] = (uint8)AUDIT_Seq;
+	AUDIT_Block[AUDIT_SEQ_OFFSET + 1] = (uint8)(AUDIT_Seq >> 8);
+	AUDIT_Block[AUDIT_TIME_OFFSET] = (uint8)time;
+	AUDIT_Block[AUDIT_TIME_OFFSET + 1] = (uint8)(time >> 8);
+	AUDIT_Block[AUDIT_TIME_OFFSET + 2] = (uint8)(time >> 16);
+
+	/* the old records must be erased, after a reset the open block is read till the first 0xFF */
+	status = LAYOUT_write(AUDIT, AUDIT_offset(index), AUDIT_Block, AUDIT_BLOCK_SIZE);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	if(AUDIT_Empty == TRUE)
+	{
+		AUDIT_Oldest = index;
+		AUDIT_Empty = FALSE;
+	}
+	else if(index == AUDIT_Oldest)
+	{
+		AUDIT_Oldest = (AUDIT_Oldest + 1) % AUDIT_BLOCKS;
+	}
+
+	if(AUDIT_ReadIndex == index)
+	{
+		AUDIT_ReadIndex = AUDIT_NO_BLOCK;
+	}
+
+	AUDIT_Newest = index;
+	AUDIT_BlockSeq[index] = AUDIT_Seq;
+	AUDIT_Open = TRUE;
+	AUDIT_Used = AUDIT_HEADER_SIZE;
+	AUDIT_Written = AUDIT_HEADER_SIZE;
+	AUDIT_Time = time & AUDIT_TIME_MASK;
+	AUDIT_User = AUDIT_NO_USER;
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_loadBlock
+ * Description  : Get the bytes of a block and a cursor on its records, the
+ *                open block is in SRAM, another block is read once (its
+ *                trailer then only its used bytes) and its CRC is checked
+ * INPUTS       : index, block (set to the bytes), cursor
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status, the cursor has no
+ *                records if the block failed its CRC)
+ **************************************************************************/
+static uint8 AUDIT_loadBlock(uint8 index, const uint8 **block, AUDIT_CursorType *cursor)
+{
+	uint16 crc;
+	uint8 used;
+	uint8 status;
+
+	if((AUDIT_Open == TRUE) && (index == AUDIT_Newest))
+	{
+		*block = AUDIT_Block;
+		AUDIT_startCursor(AUDIT_Block, AUDIT_Used, cursor);
+		return SUCCESS;
+	}
+
+	if(index != AUDIT_ReadIndex)
+	{
+		AUDIT_ReadIndex = AUDIT_NO_BLOCK;
+		AUDIT_ReadUsed = 0;
+
+		status = LAYOUT_read(AUDIT, AUDIT_offset(index) + AUDIT_USED_OFFSET, &AUDIT_ReadBuffer[AUDIT_USED_OFFSET], 3);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		used = AUDIT_ReadBuffer[AUDIT_USED_OFFSET];
+		if((used >= AUDIT_HEADER_SIZE) && (used <= AUDIT_USED_OFFSET))
+		{
+			status = LAYOUT_read(AUDIT, AUDIT_offset(index), AUDIT_ReadBuffer, used);
+			if(status != SUCCESS)
+			{
+				return status;
+			}
+
+			crc = AUDIT_ReadBuffer[AUDIT_CRC_OFFSET] | ((uint16)AUDIT_ReadBuffer[AUDIT_CRC_OFFSET + 1] << 8);
+			if(crc == CRC16_update(CRC16_compute(AUDIT_ReadBuffer, used), used))
+			{
+				AUDIT_ReadUsed = used;
+			}
+		}
+
+		AUDIT_ReadIndex = index;
+	}
+
+	*block = AUDIT_ReadBuffer;
+	AUDIT_startCursor(AUDIT_ReadBuffer, AUDIT_ReadUsed, cursor);
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_init
+ * Description  : Read the block headers to find the newest block, the next
+ *                events go on in it if a reset left it open
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_init(void)
+{
+	uint8 header[AUDIT_HEADER_SIZE + 1];	/* with the first byte of the records */
+	boolean used[AUDIT_BLOCKS];
+	AUDIT_CursorType cursor;
+	uint16 crc;
+	uint16 seq;
+	uint8 event;
+	uint8 user_id;
+	uint8 result;
+	uint8 status;
+	uint8 index;
+	uint8 end;	/* after the last whole record */
+
+	AUDIT_Empty = TRUE;
+	AUDIT_Open = FALSE;
+	AUDIT_ReadIndex = AUDIT_NO_BLOCK;
+
+	for(index = 0; index < AUDIT_BLOCKS; index++)
+	{
+		status = LAYOUT_read(AUDIT, AUDIT_offset(index), header, sizeof(header));
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		/* an erased block has no record */
+		used[index] = (header[AUDIT_HEADER_SIZE] != 0xFF);
+		if(used[index] == FALSE)
+		{
+			continue;
+		}
+
+		seq = header[AUDIT_SEQ_OFFSET] | ((uint16)header[AUDIT_SEQ_OFFSET + 1] << 8);
+		AUDIT_BlockSeq[index] = seq;
+		if((AUDIT_Empty == TRUE) || ((sint16)(seq - AUDIT_BlockSeq[AUDIT_Newest]) > 0))
+		{
+			AUDIT_Newest = index;
+			AUDIT_Empty = FALSE;
+		}
+	}
+
+	if(AUDIT_Empty == TRUE)
+	{
+		AUDIT_Seq = 0;
+		return SUCCESS;
+	}
+
+	/* blocks are opened in order, the oldest one is the first in use after the newest */
+	AUDIT_Oldest = (AUDIT_Newest + 1) % AUDIT_BLOCKS;
+	while(used[AUDIT_Oldest] == FALSE)
+	{
+		AUDIT_Oldest = (AUDIT_Oldest + 1) % AUDIT_BLOCKS;
+	}
+
+	/* count the events of the newest block */
+	status = LAYOUT_read(AUDIT, AUDIT_offset(AUDIT_Newest), AUDIT_Block, AUDIT_BLOCK_SIZE);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	crc = AUDIT_Block[AUDIT_CRC_OFFSET] | ((uint16)AUDIT_Block[AUDIT_CRC_OFFSET + 1] << 8);
+	AUDIT_Used = AUDIT_Block[AUDIT_USED_OFFSET];
+	if((AUDIT_Used < AUDIT_HEADER_SIZE) || (AUDIT_Used > AUDIT_USED_OFFSET) ||
+	   (crc != CRC16_update(CRC16_compute(AUDIT_Block, AUDIT_Used), AUDIT_Used)))
+	{
+		/* a reset left it open, its records end at the first 0xFF */
+		AUDIT_Used = AUDIT_USED_OFFSET;
+		AUDIT_Open = TRUE;
+	}
+
+	AUDIT_Seq = AUDIT_BlockSeq[AUDIT_Newest];
+	AUDIT_startCursor(AUDIT_Block, AUDIT_Used, &cursor);
+	end = cursor.position;
+	while(AUDIT_decode(AUDIT_Block, &cursor, &event, &user_id, &result) == TRUE)
+	{
+		end = cursor.position;
+		AUDIT_Seq++;
+	}
+
+	if(AUDIT_Open == TRUE)
+	{
+		AUDIT_Used = end;
+		AUDIT_Written = end;
+		AUDIT_Time = cursor.time;
+		AUDIT_User = cursor.user_id;
+
+		/* the records go on after the last one (the BOOT event gives the
+		 * time again), unless the reset cut a record, then only the whole
+		 * ones are kept and the next event opens a new block */
+		if((cursor.position != end) || (AUDIT_Block[end] != 0xFF))
+		{
+			return AUDIT_seal();
+		}
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_log
+ * Description  : Encode an event in the open block in SRAM, every page of
+ *                the block is written once it is full, the block is sealed
+ *                when the next event does not fit
+ * INPUTS       : event (FRAME_EVENT_xxx, at most AUDIT_MAX_EVENT),
+ *                user_id (AUDIT_NO_USER if none), result (FRAME_RESULT_xxx)
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE for a bad event,
+ *                or the EEPROM status, the records that could not be
+ *                written stay in SRAM and new events are dropped while the
+ *                block can not be sealed)
+ **************************************************************************/
+uint8 AUDIT_log(uint8 event, uint8 user_id, uint8 result)
+{
+	uint8 record[AUDIT_MAX_RECORD];
+	uint32 time = TICK_getMs() / 1000;
+	uint8 length;
+	uint8 full_pages;
+	uint8 status;
+	uint8 i;
+
+	if(event > AUDIT_MAX_EVENT)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	length = AUDIT_encode(record, event, user_id, result, time);
+	if((AUDIT_Open == FALSE) || ((AUDIT_Used + length) > AUDIT_USED_OFFSET))
+	{
+		if(AUDIT_Open == TRUE)
+		{
+			status = AUDIT_seal();
+			if(status != SUCCESS)
+			{
+				return status;
+			}
+		}
+
+		status = AUDIT_openBlock(time);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		/* relative to the new block now */
+		length = AUDIT_encode(record, event, user_id, result, time);
+	}
+
+	for(i = 0; i < length; i++)
+	{
+		AUDIT_Block[AUDIT_Used + i] = record[i];
+	}
+	AUDIT_Used += length;
+	AUDIT_Time = time & AUDIT_TIME_MASK;
+	if(AUDIT_usualUser(event, user_id) != AUDIT_NO_USER)
+	{
+		AUDIT_User = user_id;
+	}
+	AUDIT_Seq++;
+
+	/* write the pages that are complete now, the block starts on a page */
+	full_pages = AUDIT_Used - (AUDIT_Used % AUDIT_PAGE_SIZE);
+	if(full_pages > AUDIT_Written)
+	{
+		status = AUDIT_write(AUDIT_Written, full_pages);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+		AUDIT_Written = full_pages;
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_flush
+ * Description  : Write the events waiting in SRAM, even if their page is
+ *                not full
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_flush(void)
+{
+	uint8 status;
+
+	if(AUDIT_Open == FALSE)
+	{
+		return SUCCESS;
+	}
+
+	status = AUDIT_write(AUDIT_Written, AUDIT_Used);
+	if(status == SUCCESS)
+	{
+		AUDIT_Written = AUDIT_Used;
+	}
+
+	return status;
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_isPending
+ * Description  : Tell if some events are waiting in SRAM
+ * INPUTS       : void
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean AUDIT_isPending(void)
+{
+	return ((AUDIT_Open == TRUE) && (AUDIT_Written != AUDIT_Used));
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_getOldest
+ * Description  : SEQ of the oldest event kept in the log
+ * INPUTS       : void
+ * RETURNS      : uint16
+ **************************************************************************/
+uint16 AUDIT_getOldest(void)
+{
+	return (AUDIT_Empty == TRUE) ? AUDIT_Seq : AUDIT_BlockSeq[AUDIT_Oldest];
+}
+
+
+
+/**************************************************************************
+ * Function Name: AUDIT_read
+ * Description  : Decode consecutive events in order, from the block holding
+ *                the first one. Events already overwritten and blocks that
+ *                fail their CRC are skipped. A block is read once (only its
+ *                used bytes) and kept in SRAM for the next calls.
+ * INPUTS       : seq (first event wanted, set to the first event read),
+ *                data (count * AUDIT_RECORD_SIZE bytes),
+ *                count (records wanted, set to the records read, 0 at the end)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 AUDIT_read(uint16 *seq, uint8 *data, uint8 *count)
+{
+	AUDIT_CursorType cursor;
+	const uint8 *block;
+	uint16 event_seq;
+	uint8 wanted = *count;
+	uint8 index;
+	uint8 event;
+	uint8 user_id;
+	uint8 result;
+	uint8 status;
+
+	*count = 0;
+	if(AUDIT_Empty == TRUE)
+	{
+		return SUCCESS;
+	}
+
+	/* events before the oldest one kept are gone, go on from the oldest */
+	if(((sint16)(*seq - AUDIT_BlockSeq[AUDIT_Oldest]) < 0) || ((sint16)(*seq - AUDIT_Seq) > 0))
+	{
+		*seq = AUDIT_BlockSeq[AUDIT_Oldest];
+	}
+
+	/* the headers give the block of the first event, no record is decoded to find it */
+	index = AUDIT_Oldest;
+	while((index != AUDIT_Newest) && ((sint16)(AUDIT_BlockSeq[(index + 1) % AUDIT_BLOCKS] - *seq) <= 0))
+	{
+		index = (index + 1) % AUDIT_BLOCKS;
+	}
+
+	while(*count < wanted)
+	{
+		status = AUDIT_loadBlock(index, &block, &cursor);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		if(cursor.end == 0)
+		{
+			/* the events of a corrupted block are lost, the next call goes on after it */
+			if((*count != 0) || (index == AUDIT_Newest))
+			{
+				break;
+			}
+			index = (index + 1) % AUDIT_BLOCKS;
+			*seq = AUDIT_BlockSeq[index];
+			continue;
+		}
+
+		event_seq = AUDIT_BlockSeq[index];
+		while((*count < wanted) && (AUDIT_decode(block, &cursor, &event, &user_id, &result) == TRUE))
+		{
+			if(event_seq == (uint16)(*seq + *count))
+			{
+				data[0] = (uint8)event_seq;
+				data[1] = (uint8)(event_seq >> 8);
+				data[2] = (uint8)cursor.time;
+				data[3] = (uint8)(cursor.time >> 8);
+				data[4] = (uint8)(cursor.time >> 16);
+				data[5] = event;
+				data[6] = user_id;
+				data[7] = result;
+				data += AUDIT_RECORD_SIZE;
+				(*count)++;
+			}
+			event_seq++;
+		}
+
+		if(index == AUDIT_Newest)
+		{
+			break;
+		}
+		index = (index + 1) % AUDIT_BLOCKS;
+	}
+
+	return SUCCESS;
+}
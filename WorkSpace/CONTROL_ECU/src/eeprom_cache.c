@@ -0,0 +1,157 @@
+/*===========================================================================================
+ * Filename   : eeprom_cache.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the write-through SRAM cache of an EEPROM region
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "eeprom_cache.h"
+#include "external_eeprom.h"
+#include "crc16.h"
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+static uint8 EEPROM_CACHE_Data[EEPROM_CACHE_SIZE];
+static uint32 EEPROM_CACHE_Address = 0;
+static uint8 EEPROM_CACHE_Length = 0;
+
+/* CRC of EEPROM_CACHE_Data taken when it was last loaded or written,
+ * a copy that does not match it any more is stale and is loaded again */
+static uint16 EEPROM_CACHE_Crc = 0;
+static boolean EEPROM_CACHE_Valid = FALSE;
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_load
+ * Description  : Copy the cached region from the EEPROM to SRAM
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 EEPROM_CACHE_load(void)
+{
+	uint8 status;
+
+	status = EEPROM_readBlock(EEPROM_CACHE_Address, EEPROM_CACHE_Data, EEPROM_CACHE_Length);
+
+	EEPROM_CACHE_Valid = (status == SUCCESS);
+	if(EEPROM_CACHE_Valid == TRUE)
+	{
+		EEPROM_CACHE_Crc = CRC16_compute(EEPROM_CACHE_Data, EEPROM_CACHE_Length);
+	}
+
+	return status;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_init
+ * Description  : Load a region of the EEPROM in SRAM and keep the CRC of the
+ *                copy, reads inside the region are served from SRAM after it
+ * INPUTS       : address (start of the region), length (at most EEPROM_CACHE_SIZE)
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status of the failed load)
+ **************************************************************************/
+uint8 EEPROM_CACHE_init(uint32 address, uint8 length)
+{
+	if(length > EEPROM_CACHE_SIZE)
+	{
+		EEPROM_CACHE_Valid = FALSE;
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	EEPROM_CACHE_Address = address;
+	EEPROM_CACHE_Length = length;
+
+	return EEPROM_CACHE_load();
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_read
+ * Description  : Read a range, from SRAM if it is inside the cached region
+ *                and the copy passes its CRC check, else from the EEPROM
+ *                (the region is reloaded when the copy is stale)
+ * INPUTS       : address (first address to read from), data && length
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_CACHE_read(uint32 address, uint8 *data, uint16 length)
+{
+	uint8 status;
+	uint16 i;
+
+	/* only ranges fully inside the region are cached */
+	if((address < EEPROM_CACHE_Address) ||
+	   (address + length > EEPROM_CACHE_Address + EEPROM_CACHE_Length))
+	{
+		return EEPROM_readBlock(address, data, length);
+	}
+
+	if((EEPROM_CACHE_Valid == FALSE) ||
+	   (CRC16_compute(EEPROM_CACHE_Data, EEPROM_CACHE_Length) != EEPROM_CACHE_Crc))
+	{
+		status = EEPROM_CACHE_load();
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+	}
+
+	for(i = 0; i < length; i++)
+	{
+		data[i] = EEPROM_CACHE_Data[(address - EEPROM_CACHE_Address) + i];
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_CACHE_write
+ * Description  : Write a range to the EEPROM and, once it is accepted, to
+ *                the part of the cached region it covers
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_CACHE_write(uint32 address, const uint8 *data, uint16 length)
+{
+	uint8 status;
+	uint16 i;
+	uint32 target;
+
+	status = EEPROM_writeBlock(address, data, length);
+	if(status != SUCCESS)
+	{
+		/* part of the range may be written, the copy can not be trusted */
+		EEPROM_CACHE_Valid = FALSE;
+		return status;
+	}
+
+	/* a stale copy is not patched, the next read loads the whole region again */
+	if((EEPROM_CACHE_Valid == TRUE) &&
+	   (CRC16_compute(EEPROM_CACHE_Data, EEPROM_CACHE_Length) == EEPROM_CACHE_Crc))
+	{
+		for(i = 0; i < length; i++)
+		{
+			target = address + i;
+			if((target >= EEPROM_CACHE_Address) && (target < EEPROM_CACHE_Address + EEPROM_CACHE_Length))
+			{
+				EEPROM_CACHE_Data[target - EEPROM_CACHE_Address] = data[i];
+			}
+		}
+		EEPROM_CACHE_Crc = CRC16_compute(EEPROM_CACHE_Data, EEPROM_CACHE_Length);
+	}
+	else
+	{
+		EEPROM_CACHE_Valid = FALSE;
+	}
+
+	return SUCCESS;
+}
@@ -1,11 +1,44 @@
 /*===========================================================================================
  * Filename   : external_eprom.c
  * Author     : Ahmad Haroun
- * Description: Source File for a 2KB EXTERNAL_EEPROM DRIVER
+ * Description: Source File for the 24Cxx EXTERNAL_EEPROM DRIVER, one or more chips
  * Created on : SEP 4, 2023
  *==========================================================================================*/
 #include "external_eeprom.h"
 #include "twi.h"
+#include "tick.h"
+#include "crc16.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* longest DATA of a record, the two copies are built in one buffer */
+#define EEPROM_RECORD_MAX_DATA  (32U)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* where an address of the linear space is on the bus */
+typedef struct
+{
+	uint8 slave_address;					/* 7-bit TWI address of the chip (and block) */
+	uint8 address[EEPROM_ADDRESS_BYTES];	/* memory address sent first, high byte first */
+	uint32 chip_end;						/* first linear address of the next chip */
+}EEPROM_LocationType;
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* a write transaction ended, the chip may still be programming the page */
+static boolean EEPROM_WriteInProgress = FALSE;
+static uint32 EEPROM_WriteStart = 0;
+static uint8 EEPROM_WriteSlave = EEPROM_BASE_ADDRESS;	/* chip being programmed */
 
 
 /*******************************************************************************
@@ -13,57 +46,233 @@
  *******************************************************************************/
 
 
+/**************************************************************************
+ * Function Name: EEPROM_locate
+ * Description  : Split a linear address into the chip slave address and the
+ *                memory address inside that chip
+ * INPUTS       : address (linear address), location
+ * RETURNS      : void
+ **************************************************************************/
+static void EEPROM_locate(uint32 address, EEPROM_LocationType *location)
+{
+	uint8 chip = (uint8)(address / EEPROM_CHIP_SIZE);
+	uint16 offset = (uint16)(address % EEPROM_CHIP_SIZE);
+
+#if (EEPROM_ADDRESS_BYTES == 1)
+	/* the 256-byte block number takes the low bits of A2..A0, the chip number the ones above */
+	location->slave_address = EEPROM_BASE_ADDRESS | (chip * EEPROM_SLAVE_ADDRESSES) | (uint8)(offset >> 8);
+	location->address[0] = (uint8)offset;
+#else
+	location->slave_address = EEPROM_BASE_ADDRESS | chip;
+	location->address[0] = (uint8)(offset >> 8);
+	location->address[1] = (uint8)offset;
+#endif
+	location->chip_end = ((uint32)chip + 1) * EEPROM_CHIP_SIZE;
+}
+
+
+/**************************************************************************
+ * Function Name: EEPROM_getStatus
+ * Description  : Run a transfer (with the TWI driver retries) and map its
+ *                result to the EEPROM status codes
+ * INPUTS       : transfer (the EEPROM transaction)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+static uint8 EEPROM_getStatus(TWI_TransferType *transfer)
+{
+	switch(TWI_transfer(transfer))
+	{
+	case TWI_TRANSFER_DONE:
+		return SUCCESS;
+
+	case TWI_TRANSFER_TIMEOUT:
+		return EEPROM_TIMEOUT;
+
+	default:
+		if((transfer->error == TWI_ARB_LOST) || (transfer->error == TWI_BUS_ERROR))
+		{
+			return EEPROM_BUS_ERROR;
+		}
+		return ERROR;
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: EEPROM_write
+ * Description  : Run a write transaction once the EEPROM is ready, then mark
+ *                the write cycle it starts as in progress
+ * INPUTS       : transfer (the write transaction)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+static uint8 EEPROM_write(TWI_TransferType *transfer)
+{
+	uint8 status = EEPROM_waitReady();
+
+	if(status == SUCCESS)
+	{
+		status = EEPROM_getStatus(transfer);
+		if(status == SUCCESS)
+		{
+			EEPROM_WriteInProgress = TRUE;
+			EEPROM_WriteStart = TICK_getMs();
+			EEPROM_WriteSlave = transfer->address;
+		}
+	}
+
+	return status;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_waitReady
+ * Description  : Wait for the end of the last write cycle, by polling the
+ *                EEPROM with its address till it ACKs. Every access does it
+ *                first, so a write returns as soon as its page is sent.
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+uint8 EEPROM_waitReady(void)
+{
+	TWI_TransferType probe;
+	uint8 status;
+
+	while(EEPROM_WriteInProgress)
+	{
+		/* address only, the chip does not ACK till the write cycle ends */
+		probe.address = EEPROM_WriteSlave;
+		probe.write_buffer = NULL_PTR;
+		probe.write_length = 0;
+		probe.read_buffer = NULL_PTR;
+		probe.read_length = 0;
+		probe.repeated_start = FALSE;
+		probe.callBack = NULL_PTR;
+
+		status = EEPROM_getStatus(&probe);
+		if(status == SUCCESS)
+		{
+			EEPROM_WriteInProgress = FALSE;
+		}
+		else if(status != ERROR)
+		{
+			/* the bus itself failed, not just a busy EEPROM */
+			return status;
+		}
+		else if(TICK_isExpired(EEPROM_WriteStart + (2 * EEPROM_WRITE_CYCLE_MS)))
+		{
+			EEPROM_WriteInProgress = FALSE;
+			return EEPROM_TIMEOUT;
+		}
+	}
+
+	return SUCCESS;
+}
+
+
+
 /**************************************************************************
  * Function Name: EEPROM_writeByte
  * Description  : Write a byte in a specific address
- * INPUTS       : uint16 address(address to write in), uint8 data(data to be written)
- * RETURNS      : uint8 (status of Writing Success or Fail)
+ * INPUTS       : uint32 address(address to write in), uint8 data(data to be written)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
  **************************************************************************/
-uint8 EEPROM_writeByte(uint16 address, uint8 data)
+uint8 EEPROM_writeByte(uint32 address, uint8 data)
 {
-	/* send the start condition and check for the Acknowledgement */
-	TWI_start();
-	if(TWI_getStatus() != TWI_START)
+	return EEPROM_writePage(address, &data, 1);
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writePage
+ * Description  : Write up to one page in a single transaction, the range must
+ *                not cross a page boundary. Returns without waiting for the
+ *                write cycle, the next access waits for it.
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 EEPROM_writePage(uint32 address, const uint8 *data, uint8 length)
+{
+	/* the memory address then the data */
+	uint8 buffer[EEPROM_ADDRESS_BYTES + EEPROM_PAGE_SIZE];
+	EEPROM_LocationType location;
+	TWI_TransferType transfer;
+	uint8 i;
+
+	/* the EEPROM wraps inside the page, so a crossing write would overwrite its start */
+	if((length == 0) || (((address % EEPROM_PAGE_SIZE) + length) > EEPROM_PAGE_SIZE) ||
+	   ((address + length) > EEPROM_SIZE))
 	{
-		return ERROR;
+		return EEPROM_OUT_OF_RANGE;
 	}
 
- 	/*  EEPROM used is 2KB so its address is 11-bits so we need to transmit the upper 3-bits first
- 	 *  and after that we send the lower 8-bits
- 	 *  ((uint8) ((0xA0) | ((address & 0x0700) >> 7))) ==> this formula extracts the A8, A9 and A10 bits
- 	 *  from the address bits
- 	 *  check for the Acknowledgement
- 	 * */
-	TWI_writeByte ((uint8) (0xA0 | ((address & 0x0700)>>7)));
-	
-	if(TWI_getStatus() != TWI_MT_SLA_W_ACK)
+	/* pages never cross a chip, the whole page is in the chip of its first byte */
+	EEPROM_locate(address, &location);
+	for(i = 0; i < EEPROM_ADDRESS_BYTES; i++)
 	{
-		return ERROR;
+		buffer[i] = location.address[i];
+	}
+	for(i = 0; i < length; i++)
+	{
+		buffer[EEPROM_ADDRESS_BYTES + i] = data[i];
 	}
 
-	/* Send the rest of the address that the master wants to write in the EEPROM
-	 * check for the Acknowledgement
-	 * */
-	TWI_writeByte((uint8)address);
+	transfer.address = location.slave_address;
+	transfer.write_buffer = buffer;
+	transfer.write_length = EEPROM_ADDRESS_BYTES + length;
+	transfer.read_buffer = NULL_PTR;
+	transfer.read_length = 0;
+	transfer.repeated_start = FALSE;
+	transfer.callBack = NULL_PTR;
 
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	return EEPROM_write(&transfer);
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writeBlock
+ * Description  : Write any range, split on the page boundaries, each page is
+ *                one transaction started as soon as the previous page is
+ *                programmed
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 EEPROM_writeBlock(uint32 address, const uint8 *data, uint16 length)
+{
+	uint8 chunk;
+	uint8 status;
+
+	if(address + length > EEPROM_SIZE)
 	{
-		return ERROR;
+		return EEPROM_OUT_OF_RANGE;
 	}
 
-	/* Send the Data
-	 * check for the Acknowledgement
-	 * */
-	TWI_writeByte(data);
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	while(length != 0)
 	{
-		return ERROR;
+		/* up to the end of the current page */
+		chunk = EEPROM_PAGE_SIZE - (address % EEPROM_PAGE_SIZE);
+		if(chunk > length)
+		{
+			chunk = (uint8)length;
+		}
+
+		/* EEPROM_writePage waits for the previous page to be programmed */
+		status = EEPROM_writePage(address, data, chunk);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
 	}
 
-	TWI_stop();
-	
 	return SUCCESS;
-
 }
 
 
@@ -71,58 +280,219 @@ uint8 EEPROM_writeByte(uint16 address, uint8 data)
 /**************************************************************************
  * Function Name: EEPROM_readByte
  * Description  : Read a byte from a specific address
- * INPUTS       : uint16 address(address to read from), uint8 *data(data to be read)
- * RETURNS      : uint8 (status of Writing Success or Fail)
+ * INPUTS       : uint32 address(address to read from), uint8 *data(data to be read)
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT or EEPROM_BUS_ERROR)
+ **************************************************************************/
+uint8 EEPROM_readByte(uint32 address, uint8* data)
+{
+	return EEPROM_readBlock(address, data, 1);
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_readBlock
+ * Description  : Read a range with one addressed sequential read, every byte
+ *                is ACKed except the last one which is NACKed. The address
+ *                counter of the EEPROM crosses pages and blocks by itself.
+ * INPUTS       : address (first address to read from), data (where to save
+ *                the bytes) && length
+ * RETURNS      : uint8 (SUCCESS, ERROR, EEPROM_TIMEOUT, EEPROM_BUS_ERROR
+ *                or EEPROM_OUT_OF_RANGE)
  **************************************************************************/
-uint8 EEPROM_readByte(uint16  address, uint8* data)
+uint8 EEPROM_readBlock(uint32 address, uint8 *data, uint16 length)
 {
-	/* send the start condition and check for the Acknowledgement */
-	TWI_start();
-	if(TWI_getStatus() != TWI_START)
+	EEPROM_LocationType location;
+	uint8 chunk;
+	uint8 status;
+	TWI_TransferType transfer;
+
+	if(address + length > EEPROM_SIZE)
 	{
-		return ERROR;
+		return EEPROM_OUT_OF_RANGE;
 	}
-	/*  EEPROM used is 2KB so its address is 11-bits so we need to transmit the upper 3-bits first
-	 *  and after that we send the lower 8-bits
-	 *  ((uint8) ((0xA0) | ((address & 0x0700) >> 7))) ==> this formula extracts the A8, A9 and A10 bits
-	 *  from the address bits
-	 *  check for the Acknowledgement
-	 * */
-	 TWI_writeByte((uint8)((0xA0) | ((address & 0x0700)>>7)));
-	if(TWI_getStatus() != TWI_MT_SLA_W_ACK)
+
+	/* the EEPROM ignores reads during a write cycle */
+	status = EEPROM_waitReady();
+	if(status != SUCCESS)
 	{
-		return ERROR;
+		return status;
 	}
 
-	/* Send the rest of the address that the master wants to write in the EEPROM
-	 * check for the Acknowledgement
-	 * */
-	TWI_writeByte((uint8) address);
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	/* a transfer reads 255 bytes at most and stays in one chip,
+	 * longer ranges take more than one read */
+	while(length != 0)
 	{
-		return ERROR;
+		EEPROM_locate(address, &location);
+		chunk = (length > 0xFF) ? 0xFF : (uint8)length;
+		if((address + chunk) > location.chip_end)
+		{
+			chunk = (uint8)(location.chip_end - address);
+		}
+
+		/* write the address, then a repeated start to read the bytes */
+		transfer.address = location.slave_address;
+		transfer.write_buffer = location.address;
+		transfer.write_length = EEPROM_ADDRESS_BYTES;
+		transfer.read_buffer = data;
+		transfer.read_length = chunk;
+		transfer.repeated_start = TRUE;
+		transfer.callBack = NULL_PTR;
+
+		status = EEPROM_getStatus(&transfer);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
 	}
-	 /* Send the Repeated Start Bit */
-	TWI_start();
-	if(TWI_getStatus() != TWI_REP_START)
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_isCopyValid
+ * Description  : Check the CRC of one copy of a record
+ * INPUTS       : copy (SEQ, DATA then CRC), length (of DATA)
+ * RETURNS      : boolean
+ **************************************************************************/
+static boolean EEPROM_isCopyValid(const uint8 *copy, uint8 length)
+{
+	uint16 crc = copy[length + 1] | ((uint16)copy[length + 2] << 8);
+
+	return (crc == CRC16_compute(copy, length + 1));
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_selectRecord
+ * Description  : Pick the newest valid copy of a record already read
+ * INPUTS       : copies (EEPROM_RECORD_SIZE(length) bytes), length (of DATA)
+ * RETURNS      : const uint8* (DATA of the newest valid copy, NULL_PTR if
+ *                neither copy is valid)
+ **************************************************************************/
+const uint8* EEPROM_selectRecord(const uint8 *copies, uint8 length)
+{
+	const uint8 *copy_a = copies;
+	const uint8 *copy_b = copies + EEPROM_RECORD_COPY_SIZE(length);
+	boolean valid_a = EEPROM_isCopyValid(copy_a, length);
+	boolean valid_b = EEPROM_isCopyValid(copy_b, length);
+
+	if((valid_a == TRUE) && (valid_b == TRUE))
 	{
-		return ERROR;
+		/* SEQ wraps, the copy written last is one ahead of the other */
+		return ((sint8)(copy_b[0] - copy_a[0]) > 0) ? (copy_b + 1) : (copy_a + 1);
+	}
+	else if(valid_a == TRUE)
+	{
+		return copy_a + 1;
+	}
+	else if(valid_b == TRUE)
+	{
+		return copy_b + 1;
+	}
+
+	return NULL_PTR;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_readRecord
+ * Description  : Read both copies of a record with one sequential read and
+ *                return the DATA of the newest valid one
+ * INPUTS       : address (of the first copy), data && length
+ * RETURNS      : uint8 (SUCCESS, EEPROM_NO_RECORD or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_readRecord(uint32 address, uint8 *data, uint8 length)
+{
+	uint8 copies[EEPROM_RECORD_SIZE(EEPROM_RECORD_MAX_DATA)];
+	const uint8 *newest;
+	uint8 status;
+	uint8 i;
+
+	if(length > EEPROM_RECORD_MAX_DATA)
+	{
+		return EEPROM_OUT_OF_RANGE;
 	}
 
-    TWI_writeByte((uint8)((0xA0) | ((address & 0x0700)>>7) | 1));
-	 if(TWI_getStatus() != TWI_MT_SLA_R_ACK)
+	status = EEPROM_readBlock(address, copies, EEPROM_RECORD_SIZE(length));
+	if(status != SUCCESS)
 	{
-		return ERROR;
+		return status;
 	}
 
-	*data = TWI_readByteWithNACK();
-	if(TWI_getStatus() != TWI_MR_DATA_NACK)
+	newest = EEPROM_selectRecord(copies, length);
+	if(newest == NULL_PTR)
 	{
-		return ERROR;
+		return EEPROM_NO_RECORD;
 	}
 
-	TWI_stop();
+	for(i = 0; i < length; i++)
+	{
+		data[i] = newest[i];
+	}
 
 	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: EEPROM_writeRecord
+ * Description  : Update a record, the older (or invalid) copy is replaced
+ *                by the new DATA with the next SEQ. A reset during the write
+ *                leaves the previous value readable.
+ * INPUTS       : address (of the first copy), data && length
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE or the EEPROM status)
+ **************************************************************************/
+uint8 EEPROM_writeRecord(uint32 address, const uint8 *data, uint8 length)
+{
+	uint8 copies[EEPROM_RECORD_SIZE(EEPROM_RECORD_MAX_DATA)];
+	const uint8 *newest;
+	uint8 *target;
+	uint16 crc;
+	uint8 status;
+	uint8 i;
+
+	if(length > EEPROM_RECORD_MAX_DATA)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	/* a read costs no write cycle, it tells which copy is the one to keep */
+	status = EEPROM_readBlock(address, copies, EEPROM_RECORD_SIZE(length));
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	newest = EEPROM_selectRecord(copies, length);
+	if(newest == NULL_PTR)
+	{
+		target = copies;
+		target[0] = 0;
+	}
+	else
+	{
+		/* the other copy, one SEQ ahead */
+		target = (newest == (copies + 1)) ? (copies + EEPROM_RECORD_COPY_SIZE(length)) : copies;
+		target[0] = newest[-1] + 1;
+	}
+
+	for(i = 0; i < length; i++)
+	{
+		target[i + 1] = data[i];
+	}
+	crc = CRC16_compute(target, length + 1);
+	target[length + 1] = (uint8)crc;
+	target[length + 2] = (uint8)(crc >> 8);
 
+	return EEPROM_writeBlock(address + (uint32)(target - copies), target, EEPROM_RECORD_COPY_SIZE(length));
 }
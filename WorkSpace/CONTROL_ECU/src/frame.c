@@ -0,0 +1,344 @@
+/*===========================================================================================
+ * Filename   : frame.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the HMI_ECU <-> CONTROL_ECU frame protocol
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "frame.h"
+#include "crc16.h"
+#include "uart.h"
+#include "tick.h"
+#include "clock.h"
+
+
+#if !TICK_IS_REACHABLE(FRAME_BYTE_TIMEOUT_MS)
+#error "FRAME_BYTE_TIMEOUT_MS can not be reached with the tick"
+#endif
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* parser used by FRAME_receive, kept between calls so no byte is lost */
+static FRAME_ParserType FRAME_RxParser = {FRAME_STATE_SYNC};
+
+/* tick of the last byte fed to FRAME_RxParser by FRAME_poll */
+static uint32 FRAME_RxLastByte = 0;
+
+/* frame level counters, the UART counters are added by FRAME_getStats */
+static uint16 FRAME_Stats[FRAME_STAT_ROUND_TRIP + 1];
+
+
+/*******************************************************************************
+ *                              Functions Definitions                          *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: FRAME_initParser
+ * Description  : Reset the parser to wait for a new SYNC byte
+ * INPUTS       : parser (parser to be reset)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_initParser(FRAME_ParserType *parser)
+{
+	parser->state = FRAME_STATE_SYNC;
+	parser->index = 0;
+	parser->crc = CRC16_INITIAL_VALUE;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_parseByte
+ * Description  : Feed the parser with one received byte
+ * INPUTS       : parser, byte (the received byte)
+ * RETURNS      : FRAME_StatusType
+ *                FRAME_INCOMPLETE ==> frame is not finished yet
+ *                FRAME_COMPLETE   ==> parser->frame holds a valid frame
+ *                FRAME_ERROR      ==> bad length or CRC, the frame is dropped
+ **************************************************************************/
+FRAME_StatusType FRAME_parseByte(FRAME_ParserType *parser, uint8 byte)
+{
+	FRAME_StatusType status = FRAME_INCOMPLETE;
+
+	switch(parser->state)
+	{
+	case FRAME_STATE_SYNC:
+		/* anything before the SYNC byte is line noise */
+		if(byte == FRAME_SYNC_BYTE)
+		{
+			FRAME_initParser(parser);
+			parser->state = FRAME_STATE_OPCODE;
+		}
+		break;
+
+	case FRAME_STATE_OPCODE:
+		parser->frame.opcode = byte;
+		parser->crc = CRC16_update(parser->crc, byte);
+		parser->state = FRAME_STATE_SEQ;
+		break;
+
+	case FRAME_STATE_SEQ:
+		parser->frame.seq = byte;
+		parser->crc = CRC16_update(parser->crc, byte);
+		parser->state = FRAME_STATE_LENGTH;
+		break;
+
+	case FRAME_STATE_LENGTH:
+		if(byte > FRAME_MAX_PAYLOAD)
+		{
+			/* reject now instead of waiting for the CRC of a frame that cannot fit */
+			status = FRAME_ERROR;
+		}
+		else
+		{
+			parser->frame.length = byte;
+			parser->crc = CRC16_update(parser->crc, byte);
+			parser->state = (byte == 0) ? FRAME_STATE_CRC_LOW : FRAME_STATE_PAYLOAD;
+		}
+		break;
+
+	case FRAME_STATE_PAYLOAD:
+		parser->frame.payload[parser->index] = byte;
+		parser->crc = CRC16_update(parser->crc, byte);
+		parser->index++;
+		if(parser->index == parser->frame.length)
+		{
+			parser->state = FRAME_STATE_CRC_LOW;
+		}
+		break;
+
+	case FRAME_STATE_CRC_LOW:
+		parser->crc_low = byte;
+		parser->state = FRAME_STATE_CRC_HIGH;
+		break;
+
+	case FRAME_STATE_CRC_HIGH:
+		if(parser->crc == (((uint16)byte << 8) | parser->crc_low))
+		{
+			status = FRAME_COMPLETE;
+		}
+		else
+		{
+			status = FRAME_ERROR;
+		}
+		parser->state = FRAME_STATE_SYNC;
+		break;
+	}
+
+	if(status == FRAME_ERROR)
+	{
+		/* if the offending byte is itself a SYNC, it may start the next frame */
+		FRAME_initParser(parser);
+		if(byte == FRAME_SYNC_BYTE)
+		{
+			parser->state = FRAME_STATE_OPCODE;
+		}
+	}
+
+	return status;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_send
+ * Description  : Build a frame and send it through the UART
+ * INPUTS       : opcode, seq, payload, length (must not exceed FRAME_MAX_PAYLOAD)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_send(uint8 opcode, uint8 seq, const uint8 *payload, uint8 length)
+{
+	uint8 i;
+	uint16 crc = CRC16_INITIAL_VALUE;
+
+	if(length > FRAME_MAX_PAYLOAD)
+	{
+		length = FRAME_MAX_PAYLOAD;
+	}
+
+	crc = CRC16_update(crc, opcode);
+	crc = CRC16_update(crc, seq);
+	crc = CRC16_update(crc, length);
+
+	UART_sendByte(FRAME_SYNC_BYTE);
+	UART_sendByte(opcode);
+	UART_sendByte(seq);
+	UART_sendByte(length);
+	for(i = 0; i < length; i++)
+	{
+		crc = CRC16_update(crc, payload[i]);
+		UART_sendByte(payload[i]);
+	}
+	UART_sendByte((uint8)crc);
+	UART_sendByte((uint8)(crc >> 8));
+
+	FRAME_Stats[FRAME_STAT_FRAMES_SENT]++;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_receive
+ * Description  : Wait until a complete valid frame is received,
+ *                corrupted frames are silently dropped
+ * INPUTS       : frame (where the received frame is saved),
+ *                timeout_ms (deadline for the whole frame or FRAME_WAIT_FOREVER)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_TIMEOUT)
+ **************************************************************************/
+FRAME_StatusType FRAME_receive(FRAME_Type *frame, uint16 timeout_ms)
+{
+	uint32 deadline = TICK_getMs() + timeout_ms;
+	FRAME_StatusType status;
+	uint8 byte;
+
+	while(1)
+	{
+		if(UART_recieveByteTimeout(&byte, FRAME_BYTE_TIMEOUT_MS) == UART_OK)
+		{
+			status = FRAME_parseByte(&FRAME_RxParser, byte);
+			if(status == FRAME_COMPLETE)
+			{
+				FRAME_Stats[FRAME_STAT_FRAMES_RECEIVED]++;
+				*frame = FRAME_RxParser.frame;
+				return FRAME_COMPLETE;
+			}
+			else if(status == FRAME_ERROR)
+			{
+				FRAME_Stats[FRAME_STAT_CRC_ERRORS]++;
+			}
+		}
+		else
+		{
+			/* the line went quiet, drop any partial frame */
+			FRAME_initParser(&FRAME_RxParser);
+		}
+
+		if((timeout_ms != FRAME_WAIT_FOREVER) && TICK_isExpired(deadline))
+		{
+			return FRAME_TIMEOUT;
+		}
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_poll
+ * Description  : Feed the parser with the bytes already received, without
+ *                waiting, corrupted frames are silently dropped and a
+ *                partial frame is kept for the next call
+ * INPUTS       : frame (where the received frame is saved)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_INCOMPLETE)
+ **************************************************************************/
+FRAME_StatusType FRAME_poll(FRAME_Type *frame)
+{
+	FRAME_StatusType status;
+	uint8 byte;
+
+	while(UART_read(&byte, 1) != 0)
+	{
+		/* the line went quiet since the last byte, drop any partial frame */
+		if(TICK_isExpired(FRAME_RxLastByte + FRAME_BYTE_TIMEOUT_MS))
+		{
+			FRAME_initParser(&FRAME_RxParser);
+		}
+		FRAME_RxLastByte = TICK_getMs();
+
+		status = FRAME_parseByte(&FRAME_RxParser, byte);
+		if(status == FRAME_COMPLETE)
+		{
+			FRAME_Stats[FRAME_STAT_FRAMES_RECEIVED]++;
+			*frame = FRAME_RxParser.frame;
+			return FRAME_COMPLETE;
+		}
+		else if(status == FRAME_ERROR)
+		{
+			FRAME_Stats[FRAME_STAT_CRC_ERRORS]++;
+		}
+	}
+
+	return FRAME_INCOMPLETE;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_roundTrip
+ * Description  : Convert a round trip to the unit of its link counter
+ * INPUTS       : us (round trip in microseconds)
+ * RETURNS      : uint16 (in FRAME_ROUND_TRIP_UNIT_US, saturated)
+ **************************************************************************/
+static uint16 FRAME_roundTrip(uint32 us)
+{
+	us /= FRAME_ROUND_TRIP_UNIT_US;
+
+	return (us > 0xFFFFUL) ? 0xFFFF : (uint16)us;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_transact
+ * Description  : Send a request and wait for its response, responses that
+ *                do not match the request opcode and sequence are dropped,
+ *                the request is sent again (same sequence) when no response arrives
+ * INPUTS       : request, response (where the response is saved),
+ *                timeout_ms (wait for each try), retries (extra tries after the first)
+ * RETURNS      : FRAME_StatusType (FRAME_COMPLETE or FRAME_TIMEOUT)
+ **************************************************************************/
+FRAME_StatusType FRAME_transact(const FRAME_Type *request, FRAME_Type *response, uint16 timeout_ms, uint8 retries)
+{
+	uint32 deadline;
+	uint32 start;
+	sint32 remaining;
+	boolean first_try = TRUE;
+
+	do
+	{
+		if(first_try == FALSE)
+		{
+			FRAME_Stats[FRAME_STAT_RETRIES]++;
+		}
+		first_try = FALSE;
+
+		start = CLOCK_micros();
+		FRAME_send(request->opcode, request->seq, request->payload, request->length);
+
+		deadline = TICK_getMs() + timeout_ms;
+		remaining = timeout_ms;
+		while((remaining > 0) && (FRAME_receive(response, (uint16)remaining) == FRAME_COMPLETE))
+		{
+			if((response->opcode == (request->opcode | FRAME_OP_RESPONSE)) && (response->seq == request->seq))
+			{
+				FRAME_Stats[FRAME_STAT_ROUND_TRIP] = FRAME_roundTrip(CLOCK_micros() - start);
+				return FRAME_COMPLETE;
+			}
+
+			/* a stale response, keep waiting for the rest of this try */
+			remaining = (sint32)(deadline - TICK_getMs());
+		}
+
+		FRAME_Stats[FRAME_STAT_TIMEOUTS]++;
+	}while(retries-- != 0);
+
+	return FRAME_TIMEOUT;
+}
+
+
+/**************************************************************************
+ * Function Name: FRAME_getStats
+ * Description  : Get the link statistics of this ECU (frame and UART counters)
+ * INPUTS       : stats (array of FRAME_STATS_NUM counters indexed by FRAME_StatIndex)
+ * RETURNS      : void
+ **************************************************************************/
+void FRAME_getStats(uint16 *stats)
+{
+	UART_StatsType uart_stats;
+	uint8 i;
+
+	for(i = 0; i <= FRAME_STAT_ROUND_TRIP; i++)
+	{
+		stats[i] = FRAME_Stats[i];
+	}
+
+	UART_getStats(&uart_stats);
+	stats[FRAME_STAT_OVERRUN_ERRORS] = uart_stats.overrun_errors;
+	stats[FRAME_STAT_FRAMING_ERRORS] = uart_stats.framing_errors;
+	stats[FRAME_STAT_PARITY_ERRORS] = uart_stats.parity_errors;
+	stats[FRAME_STAT_BUFFER_OVERRUNS] = uart_stats.buffer_overruns;
+}
@@ -0,0 +1,100 @@
+/*===========================================================================================
+ * Filename   : internal_eeprom.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the on-chip EEPROM of the ATmega32 (avr-libc eeprom.h)
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "internal_eeprom.h"
+#include <avr/eeprom.h>
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_isInRange
+ * Description  : Check that a range fits in the EEPROM
+ * INPUTS       : address && length
+ * RETURNS      : boolean
+ **************************************************************************/
+static boolean INTERNAL_EEPROM_isInRange(uint32 address, uint16 length)
+{
+	return ((address <= INTERNAL_EEPROM_SIZE) && (length <= (INTERNAL_EEPROM_SIZE - address)));
+}
+
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_waitReady
+ * Description  : Wait for the end of the last byte write
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_waitReady(void)
+{
+	eeprom_busy_wait();
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_writePage
+ * Description  : Write a range that does not cross a page boundary
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_writePage(uint32 address, const uint8 *data, uint8 length)
+{
+	if(((address % INTERNAL_EEPROM_PAGE_SIZE) + length) > INTERNAL_EEPROM_PAGE_SIZE)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	return INTERNAL_EEPROM_writeBlock(address, data, length);
+}
+
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_writeBlock
+ * Description  : Write any range, the bytes that already hold their value
+ *                are skipped (no write cycle, no wear)
+ * INPUTS       : address (first address to write in), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_writeBlock(uint32 address, const uint8 *data, uint16 length)
+{
+	if(INTERNAL_EEPROM_isInRange(address, length) == FALSE)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	/* avr-libc waits for the previous byte before each one, and keeps the
+	 * interrupts disabled only for the EEMWE/EEWE sequence */
+	eeprom_update_block(data, (void *)(uint16)address, length);
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: INTERNAL_EEPROM_readBlock
+ * Description  : Read any range, a few CPU cycles per byte
+ * INPUTS       : address (first address to read from), data && length
+ * RETURNS      : uint8 (SUCCESS or EEPROM_OUT_OF_RANGE)
+ **************************************************************************/
+uint8 INTERNAL_EEPROM_readBlock(uint32 address, uint8 *data, uint16 length)
+{
+	if(INTERNAL_EEPROM_isInRange(address, length) == FALSE)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	eeprom_read_block(data, (const void *)(uint16)address, length);
+
+	return SUCCESS;
+}
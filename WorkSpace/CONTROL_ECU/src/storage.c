@@ -0,0 +1,106 @@
+/*===========================================================================================
+ * Filename   : storage.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the storage interface over the internal and external EEPROMs
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "storage.h"
+
+#if (STORAGE_BENCHMARK == 1)
+
+#include "layout.h"
+#include "clock.h"
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* the benchmark runs the same loops on both backends */
+typedef uint8 (*STORAGE_ReadType)(uint32 address, uint8 *data, uint16 length);
+typedef uint8 (*STORAGE_WriteType)(uint32 address, const uint8 *data, uint16 length);
+typedef uint8 (*STORAGE_SyncType)(void);
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: STORAGE_measure
+ * Description  : Measure the read and write latency of one backend
+ * INPUTS       : read, write && sync (functions of the backend),
+ *                address (scratch area), latency
+ * RETURNS      : uint8 (SUCCESS or the status of the failed access)
+ **************************************************************************/
+static uint8 STORAGE_measure(STORAGE_ReadType read, STORAGE_WriteType write, STORAGE_SyncType sync,
+		uint32 address, STORAGE_LatencyType *latency)
+{
+	uint8 data[STORAGE_BENCH_LENGTH];
+	uint32 start;
+	uint8 status;
+	uint16 n;
+	uint8 i;
+
+	start = CLOCK_micros();
+	for(n = 0; n < STORAGE_BENCH_READS; n++)
+	{
+		status = read(address, data, STORAGE_BENCH_LENGTH);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+	}
+	latency->read_us = (CLOCK_micros() - start) / STORAGE_BENCH_READS;
+
+	start = CLOCK_micros();
+	for(n = 0; n < STORAGE_BENCH_WRITES; n++)
+	{
+		/* every byte changes from one write to the next, none is skipped */
+		for(i = 0; i < STORAGE_BENCH_LENGTH; i++)
+		{
+			data[i] = ((n & 1) ? 0xAA : 0x55) ^ i;
+		}
+
+		status = write(address, data, STORAGE_BENCH_LENGTH);
+		if(status == SUCCESS)
+		{
+			status = sync();
+		}
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+	}
+	latency->write_us = (CLOCK_micros() - start) / STORAGE_BENCH_WRITES;
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORAGE_benchmark
+ * Description  : Measure the average read and write latency of both
+ *                backends with CLOCK_micros, over many accesses. Run it on
+ *                the target (the tick and the TWI must be initialized) and
+ *                read the result with the debugger, it takes about 1.5 s.
+ * INPUTS       : result
+ * RETURNS      : uint8 (SUCCESS or the status of the failed access)
+ **************************************************************************/
+uint8 STORAGE_benchmark(STORAGE_BenchmarkType *result)
+{
+	uint8 status;
+
+	status = STORAGE_measure(STORAGE_read(LAYOUT_BACKEND(BENCH_INTERNAL)), STORAGE_write(LAYOUT_BACKEND(BENCH_INTERNAL)),
+			STORAGE_sync(LAYOUT_BACKEND(BENCH_INTERNAL)), LAYOUT_START(BENCH_INTERNAL), &result->internal);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	return STORAGE_measure(STORAGE_read(LAYOUT_BACKEND(BENCH_EXTERNAL)), STORAGE_write(LAYOUT_BACKEND(BENCH_EXTERNAL)),
+			STORAGE_sync(LAYOUT_BACKEND(BENCH_EXTERNAL)), LAYOUT_START(BENCH_EXTERNAL), &result->external);
+}
+
+#endif /* STORAGE_BENCHMARK */
@@ -0,0 +1,413 @@
+/*===========================================================================================
+ * Filename   : store.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the log-structured key/record store over an EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "store.h"
+#include "eeprom_cache.h"
+#include "crc16.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* offsets in a record */
+#define STORE_KEY_OFFSET      (0U)
+#define STORE_LENGTH_OFFSET   (1U)
+#define STORE_SEQ_OFFSET      (2U)
+#define STORE_VALUE_OFFSET    (STORE_HEADER_SIZE)
+#define STORE_CRC_OFFSET      (STORE_SLOT_SIZE - 2U)
+
+/* The SRAM cache saves the bus transactions of the external EEPROM, an
+ * on-chip read is already faster than its CRC check so it is skipped there */
+#if (STORAGE_IS_ON_CHIP(STORE_BACKEND) == 1)
+#define STORE_readSlot(slot, record)   LAYOUT_read(STORE, STORE_slotOffset(slot), (record), STORE_SLOT_SIZE)
+#define STORE_writeSlot(slot, record)  LAYOUT_write(STORE, STORE_slotOffset(slot), (record), STORE_SLOT_SIZE)
+#define STORE_cacheSlot(slot)
+#else
+#define STORE_readSlot(slot, record)   EEPROM_CACHE_read(LAYOUT_ADDRESS(STORE, STORE_slotOffset(slot)), (record), STORE_SLOT_SIZE)
+#define STORE_writeSlot(slot, record)  EEPROM_CACHE_write(LAYOUT_ADDRESS(STORE, STORE_slotOffset(slot)), (record), STORE_SLOT_SIZE)
+#define STORE_cacheSlot(slot)          EEPROM_CACHE_init(LAYOUT_ADDRESS(STORE, STORE_slotOffset(slot)), STORE_SLOT_SIZE)
+#endif
+
+/* index entry of a key that has no record */
+#define STORE_NO_SLOT         (0xFFU)
+#define STORE_NO_KEY          (0xFFU)
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* RAM index, slot of the newest record of each key */
+static uint8 STORE_Index[STORE_MAX_KEYS];
+
+/********************************************************************************
+ * Circular log state
+ * Head : next slot to be written
+ * Tail : oldest slot that may hold a live record
+ * Free : number of slots from Head up to Tail, none of them is live
+ *********************************************************************************/
+static uint8 STORE_Head = 0;
+static uint8 STORE_Tail = 0;
+static uint8 STORE_Free = 0;
+
+/* SEQ of the newest record */
+static uint16 STORE_Seq = 0;
+
+static boolean STORE_Mounted = FALSE;
+static uint8 STORE_CachedKey = STORE_NO_KEY;
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: STORE_slotOffset
+ * Description  : Offset of a slot in the store region
+ * INPUTS       : slot
+ * RETURNS      : uint16 (offset of the first byte of the slot)
+ **************************************************************************/
+static uint16 STORE_slotOffset(uint8 slot)
+{
+	return (uint16)slot * STORE_SLOT_SIZE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_keyAt
+ * Description  : Find the key whose newest record is in a slot
+ * INPUTS       : slot
+ * RETURNS      : uint8 (the key, STORE_NO_KEY if the slot is not live)
+ **************************************************************************/
+static uint8 STORE_keyAt(uint8 slot)
+{
+	uint8 key;
+
+	for(key = 0; key < STORE_MAX_KEYS; key++)
+	{
+		if(STORE_Index[key] == slot)
+		{
+			return key;
+		}
+	}
+
+	return STORE_NO_KEY;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_isValid
+ * Description  : Check the fields and the CRC of a record
+ * INPUTS       : record (STORE_SLOT_SIZE bytes)
+ * RETURNS      : boolean
+ **************************************************************************/
+static boolean STORE_isValid(const uint8 *record)
+{
+	uint16 crc;
+
+	/* an erased slot (0xFF) fails here already */
+	if((record[STORE_KEY_OFFSET] >= STORE_MAX_KEYS) || (record[STORE_LENGTH_OFFSET] > STORE_MAX_VALUE))
+	{
+		return FALSE;
+	}
+
+	crc = record[STORE_CRC_OFFSET] | ((uint16)record[STORE_CRC_OFFSET + 1] << 8);
+
+	return (crc == CRC16_compute(record, STORE_CRC_OFFSET));
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_append
+ * Description  : Write a record of a key at the head, with the next SEQ
+ * INPUTS       : key, data && length
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 STORE_append(uint8 key, const uint8 *data, uint8 length)
+{
+	uint8 record[STORE_SLOT_SIZE];
+	uint16 seq = STORE_Seq + 1;
+	uint16 crc;
+	uint8 status;
+	uint8 i;
+
+	record[STORE_KEY_OFFSET] = key;
+	record[STORE_LENGTH_OFFSET] = length;
+	record[STORE_SEQ_OFFSET] = (uint8)seq;
+	record[STORE_SEQ_OFFSET + 1] = (uint8)(seq >> 8);
+	for(i = 0; i < STORE_MAX_VALUE; i++)
+	{
+		record[STORE_VALUE_OFFSET + i] = (i < length) ? data[i] : 0xFF;
+	}
+	crc = CRC16_compute(record, STORE_CRC_OFFSET);
+	record[STORE_CRC_OFFSET] = (uint8)crc;
+	record[STORE_CRC_OFFSET + 1] = (uint8)(crc >> 8);
+
+	/* a slot never crosses a page, so one write cycle */
+	status = STORE_writeSlot(STORE_Head, record);
+	if(status != SUCCESS)
+	{
+		/* the head slot may be torn, it is not live so it is just written again */
+		return status;
+	}
+
+	STORE_Seq = seq;
+	STORE_Index[key] = STORE_Head;
+	STORE_Head = (STORE_Head + 1) % STORE_SLOTS;
+	STORE_Free--;
+
+	if(key == STORE_CachedKey)
+	{
+		STORE_cacheSlot(STORE_Index[key]);
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_reclaim
+ * Description  : Free the tail slot, a live record there is first
+ *                copied to the head so it is never lost
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 STORE_reclaim(void)
+{
+	uint8 record[STORE_SLOT_SIZE];
+	uint8 key = STORE_keyAt(STORE_Tail);
+	uint8 status;
+
+	if(key != STORE_NO_KEY)
+	{
+		status = STORE_readSlot(STORE_Tail, record);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		if(STORE_isValid(record) == TRUE)
+		{
+			status = STORE_append(key, &record[STORE_VALUE_OFFSET], record[STORE_LENGTH_OFFSET]);
+			if(status != SUCCESS)
+			{
+				return status;
+			}
+		}
+		else
+		{
+			/* the record went bad since the mount, there is nothing left to keep */
+			STORE_Index[key] = STORE_NO_SLOT;
+		}
+	}
+
+	STORE_Tail = (STORE_Tail + 1) % STORE_SLOTS;
+	STORE_Free++;
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_mount
+ * Description  : Scan every slot once and build the RAM index (newest valid
+ *                record of each key), the head (after the newest record)
+ *                and the tail (oldest live record).
+ *                Mount time is bounded by the store size: every slot is a
+ *                CRC over 14 bytes (~0.2 ms at 8 MHz) plus one read, a few us
+ *                on-chip or 19 bytes on the bus (~0.45 ms at 400 kHz), so
+ *                about 7 ms for the 32 slots of 512 bytes on-chip (21 ms on
+ *                the external EEPROM), whatever the content is.
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_mount(void)
+{
+	uint8 record[STORE_SLOT_SIZE];
+	uint16 key_seq[STORE_MAX_KEYS];
+	uint16 seq;
+	uint8 newest_slot = 0;
+	boolean found = FALSE;
+	uint8 status;
+	uint8 key;
+	uint16 slot;
+	uint8 i;
+
+	STORE_Mounted = FALSE;
+	for(key = 0; key < STORE_MAX_KEYS; key++)
+	{
+		STORE_Index[key] = STORE_NO_SLOT;
+	}
+
+	for(slot = 0; slot < STORE_SLOTS; slot++)
+	{
+		status = LAYOUT_read(STORE, STORE_slotOffset(slot), record, STORE_SLOT_SIZE);
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+
+		if(STORE_isValid(record) == FALSE)
+		{
+			continue;
+		}
+
+		key = record[STORE_KEY_OFFSET];
+		seq = record[STORE_SEQ_OFFSET] | ((uint16)record[STORE_SEQ_OFFSET + 1] << 8);
+
+		/* SEQ wraps, every record on the device is from the last lap of the log
+		 * so the signed difference tells which one is newer */
+		if((STORE_Index[key] == STORE_NO_SLOT) || ((sint16)(seq - key_seq[key]) > 0))
+		{
+			STORE_Index[key] = (uint8)slot;
+			key_seq[key] = seq;
+		}
+
+		if((found == FALSE) || ((sint16)(seq - STORE_Seq) > 0))
+		{
+			STORE_Seq = seq;
+			newest_slot = (uint8)slot;
+			found = TRUE;
+		}
+	}
+
+	if(found == FALSE)
+	{
+		STORE_Seq = 0;
+		newest_slot = STORE_SLOTS - 1;
+	}
+
+	/* the slots from the head up to the first live one are free */
+	STORE_Head = (newest_slot + 1) % STORE_SLOTS;
+	STORE_Tail = STORE_Head;
+	STORE_Free = STORE_SLOTS;
+	for(i = 0; i < STORE_SLOTS; i++)
+	{
+		if(STORE_keyAt((STORE_Head + i) % STORE_SLOTS) != STORE_NO_KEY)
+		{
+			STORE_Tail = (STORE_Head + i) % STORE_SLOTS;
+			STORE_Free = i;
+			break;
+		}
+	}
+
+	STORE_Mounted = TRUE;
+
+	if(STORE_CachedKey != STORE_NO_KEY)
+	{
+		STORE_setCachedKey(STORE_CachedKey);
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_read
+ * Description  : Read the newest value of a key, with one block read
+ * INPUTS       : key, data (at least STORE_MAX_VALUE bytes), length (value length)
+ * RETURNS      : uint8 (SUCCESS, STORE_NOT_FOUND, EEPROM_OUT_OF_RANGE for a
+ *                bad key, ERROR if the record fails its CRC, or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_read(uint8 key, uint8 *data, uint8 *length)
+{
+	uint8 record[STORE_SLOT_SIZE];
+	uint8 status;
+	uint8 i;
+
+	if(key >= STORE_MAX_KEYS)
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	if((STORE_Mounted == FALSE) || (STORE_Index[key] == STORE_NO_SLOT))
+	{
+		return STORE_NOT_FOUND;
+	}
+
+	status = STORE_readSlot(STORE_Index[key], record);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	if((STORE_isValid(record) == FALSE) || (record[STORE_KEY_OFFSET] != key))
+	{
+		return ERROR;
+	}
+
+	*length = record[STORE_LENGTH_OFFSET];
+	for(i = 0; i < *length; i++)
+	{
+		data[i] = record[STORE_VALUE_OFFSET + i];
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_write
+ * Description  : Append a new value of a key at the head of the log, the
+ *                oldest slots are reclaimed first (live ones are moved to
+ *                the head) so every slot wears at the same rate
+ * INPUTS       : key, data && length (at most STORE_MAX_VALUE)
+ * RETURNS      : uint8 (SUCCESS, EEPROM_OUT_OF_RANGE or the EEPROM status)
+ **************************************************************************/
+uint8 STORE_write(uint8 key, const uint8 *data, uint8 length)
+{
+	uint8 status;
+
+	if((key >= STORE_MAX_KEYS) || (length > STORE_MAX_VALUE))
+	{
+		return EEPROM_OUT_OF_RANGE;
+	}
+
+	if(STORE_Mounted == FALSE)
+	{
+		return ERROR;
+	}
+
+	/* garbage collection, slot by slot from the tail */
+	while(STORE_Free <= STORE_RESERVE_SLOTS)
+	{
+		status = STORE_reclaim();
+		if(status != SUCCESS)
+		{
+			return status;
+		}
+	}
+
+	return STORE_append(key, data, length);
+}
+
+
+
+/**************************************************************************
+ * Function Name: STORE_setCachedKey
+ * Description  : Keep the record of one key in the SRAM cache, its reads
+ *                do not touch the bus any more (the cache follows the record
+ *                when it moves to a new slot). Nothing to do on-chip.
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void STORE_setCachedKey(uint8 key)
+{
+	STORE_CachedKey = key;
+
+	if((STORE_Mounted == TRUE) && (key < STORE_MAX_KEYS) && (STORE_Index[key] != STORE_NO_SLOT))
+	{
+		STORE_cacheSlot(STORE_Index[key]);
+	}
+}
@@ -6,6 +6,7 @@
  *==========================================================================================*/
 
 #include "timer0.h"
+#include "isr_hooks.h"
 
 /*******************************************************************************
  *                               Global_Variables Declaration                  *
@@ -21,28 +22,32 @@ volatile uint8 Timer0_Counter_PWM_Mode = 0;
  *******************************************************************************/
 
 
-#if (0)
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR TIMER0_OVF_vect)
- * Description  : Call the Function that is required to be Executed when TIMER0_OVF happens
+ * Description  : Execute the handler bound to TIMER0_OVF in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER0_OVF_HOOK
 ISR(TIMER0_OVF_vect)
 {
-
-	(*TIMER0_CallBack_Array[0])();
+	TIMER0_OVF_HOOK();
 }
+#else
+EMPTY_INTERRUPT(TIMER0_OVF_vect)
+#endif
 
 
 
 /**************************************************************************
- * Function Name: ISR (INTERRUPT HANDLER FOR TIMER1_COMPA_vect)
- * Description  : Call the Function that is required to be Executed when TIMER0_COMPA happens
+ * Function Name: ISR (INTERRUPT HANDLER FOR TIMER0_COMP_vect)
+ * Description  : Execute the handler bound to TIMER0_COMP in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER0_COMP_HOOK
 ISR(TIMER0_COMP_vect)
 {
-	(*TIMER0_CallBack_Array[1])();
+	TIMER0_COMP_HOOK();
 }
-
+#else
+EMPTY_INTERRUPT(TIMER0_COMP_vect)
 #endif
 
 
@@ -139,16 +144,3 @@ void TIMER0_Init_PWM_Mode(uint8 Compare_Value,PWM_Output_Mode OutPutPin_Mode
 
 	}
 }
-
-
-
-/**********************************************************************************
- * Function Name: TIMER0_Set_CallBack
- * Description  : A Function to set the callBack functions for Timer1 Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
- * RETURNS      : void
- **********************************************************************************/
-void TIMER0_Set_CallBack(void(* ptr_2_fun)(void),uint8 index)
-{
-	TIMER0_CallBack_Array[index] = ptr_2_fun;
-}
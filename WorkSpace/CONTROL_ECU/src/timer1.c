@@ -6,6 +6,7 @@
  *==========================================================================================*/
 
 #include "timer1.h"
+#include "isr_hooks.h"
 
 /*******************************************************************************
  *                               Global_Variables Declaration                  *
@@ -21,46 +22,58 @@ volatile uint8 Timer1_Counter_PWM_Mode = 0;
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR TIMER1_OVF_vect)
- * Description  : Call the Function that is required to be Executed when TIMER1_OVF happens
+ * Description  : Execute the handler bound to TIMER1_OVF in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER1_OVF_HOOK
 ISR(TIMER1_OVF_vect)
 {
-
-	(*TIMER1_CallBack_Array[0])();
+	TIMER1_OVF_HOOK();
 }
+#else
+EMPTY_INTERRUPT(TIMER1_OVF_vect)
+#endif
 
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR TIMER1_COMPA_vect)
- * Description  : Call the Function that is required to be Executed when TIMER1_COMPA happens
+ * Description  : Execute the handler bound to TIMER1_COMPA in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER1_COMPA_HOOK
 ISR(TIMER1_COMPA_vect)
 {
-	(*TIMER1_CallBack_Array[1])();
+	TIMER1_COMPA_HOOK();
 }
-
+#else
+EMPTY_INTERRUPT(TIMER1_COMPA_vect)
+#endif
 
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR TIMER1_COMPB_vect)
- * Description  : Call the Function that is required to be Executed when TIMER1_COMPB happens
+ * Description  : Execute the handler bound to TIMER1_COMPB in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER1_COMPB_HOOK
 ISR(TIMER1_COMPB_vect)
 {
-
-	(*TIMER1_CallBack_Array[2])();
+	TIMER1_COMPB_HOOK();
 }
+#else
+EMPTY_INTERRUPT(TIMER1_COMPB_vect)
+#endif
 
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR TIMER1_CAPT_vect)
- * Description  : Call the Function that is required to be Executed when TIMER1_CAPT happens
+ * Description  : Execute the handler bound to TIMER1_CAPT in isr_hooks.h
  **************************************************************************/
+#ifdef TIMER1_CAPT_HOOK
 ISR(TIMER1_CAPT_vect)
 {
-	(*TIMER1_CallBack_Array[3])();
-
+	TIMER1_CAPT_HOOK();
 }
+#else
+EMPTY_INTERRUPT(TIMER1_CAPT_vect)
+#endif
 
 
 
@@ -217,16 +230,3 @@ void Timer1_deInit(void)
 {
 	TCCR1B = 0;
 }
-
-
-
-/**********************************************************************************
- * Function Name: TIMER1_Set_CallBack
- * Description  : A Function to set the callBack functions for Timer1 Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
- * RETURNS      : void
- **********************************************************************************/
-void TIMER1_Set_CallBack(void(* ptr_2_fun)(void),uint8 index)
-{
-	TIMER1_CallBack_Array[index] = ptr_2_fun;
-}
@@ -5,12 +5,55 @@
  * Created on : SEP 4, 2023
  *==========================================================================================*/
 #include "twi.h"
+#include "tick.h"
+#include <avr/delay.h>
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/********************************************************************************
+ * Transfer Queue
+ * Head is only moved by TWI_submit, Tail only by TWI_vect when a transfer ends,
+ * the transfer at Tail is the one on the bus.
+ * The indices are free running uint8 counters, (Head - Tail) is the fill level
+ *********************************************************************************/
+static TWI_TransferType * volatile TWI_Queue[TWI_QUEUE_SIZE];
+static volatile uint8 TWI_QueueHead = 0;
+static volatile uint8 TWI_QueueTail = 0;
+
+/* state of the transfer on the bus */
+static volatile uint8 TWI_Index = 0;				/* next byte of the current phase */
+static volatile boolean TWI_ReadPhase = FALSE;
+static volatile uint32 TWI_StartTime = 0;			/* tick when the transfer got the bus */
+
+/* TWCR values used by the engine, all keep the module and its interrupt enabled */
+#define TWI_CMD_START      ((1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE))
+#define TWI_CMD_STOP_START ((1 << TWINT) | (1 << TWSTO) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE))
+#define TWI_CMD_NEXT       ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWI_CMD_NEXT_ACK   ((1 << TWINT) | (1 << TWEA) | (1 << TWEN) | (1 << TWIE))
 
 
 /*******************************************************************************
  *                              Functions Definitions                          *
  *******************************************************************************/
 
+
+/**************************************************************************
+ * Function Name: TWI_waitFlag
+ * Description  : wait until TWINT is set or TWI_TIMEOUT_MS passes, so a
+ *                stuck bus can not hang the polling functions
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+static void TWI_waitFlag(void)
+{
+	uint32 deadline = TICK_getMs() + TWI_TIMEOUT_MS;
+
+	while(BIT_IS_CLEAR(TWCR,TWINT) && !TICK_isExpired(deadline));
+}
+
  
 /**************************************************************************
  * Function Name: TWI_init
@@ -34,6 +77,311 @@ void TWI_init(const TWI_ConfigType * Config_Ptr)
 	                                               put the address of this SPI Device in this register
 	                                               to be used when any master wants to speak to me when i am a slave */
 	TWCR  = (1<<TWEN);
+
+	TWI_QueueHead = 0;
+	TWI_QueueTail = 0;
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_beginTransfer
+ * Description  : Prepare the state machine for a transfer getting the bus
+ *                (called from TWI_vect, or with the interrupts disabled)
+ * INPUTS       : transfer (transfer at the queue tail)
+ * RETURNS      : void
+ **************************************************************************/
+static void TWI_beginTransfer(TWI_TransferType *transfer)
+{
+	TWI_Index = 0;
+	TWI_ReadPhase = ((transfer->write_length == 0) && (transfer->read_length != 0));
+	TWI_StartTime = TICK_getMs();
+	transfer->status = TWI_TRANSFER_BUSY;
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_finish
+ * Description  : End the current transfer with a STOP, report it && start
+ *                the next queued one (called from TWI_vect, or with the
+ *                interrupts disabled)
+ * INPUTS       : status (TWI_TRANSFER_DONE, FAILED or TIMEOUT),
+ *                error (TWSR status that stopped the transfer)
+ * RETURNS      : void
+ **************************************************************************/
+static void TWI_finish(TWI_TransferStatus status, uint8 error)
+{
+	TWI_TransferType *transfer = TWI_Queue[TWI_QueueTail & (TWI_QUEUE_SIZE - 1)];
+
+	/* after a lost arbitration the bus belongs to the other master, leave it without a STOP */
+	uint8 stop = (error == TWI_ARB_LOST) ? 0 : (1 << TWSTO);
+
+	TWI_QueueTail++;
+
+	if(TWI_QueueHead != TWI_QueueTail)
+	{
+		/* STOP followed by the START of the next transfer, the START waits for a free bus */
+		TWI_beginTransfer(TWI_Queue[TWI_QueueTail & (TWI_QUEUE_SIZE - 1)]);
+		TWCR = TWI_CMD_START | stop;
+	}
+	else
+	{
+		TWCR = (1 << TWINT) | (1 << TWEN) | stop;
+	}
+
+	transfer->error = error;
+	transfer->status = status;
+
+	if(transfer->callBack != NULL_PTR)
+	{
+		transfer->callBack(transfer);
+	}
+}
+
+
+
+/**************************************************************************
+ * Function Name: ISR (INTERRUPT HANDLER FOR TWI_vect)
+ * Description  : Master state machine, one step per bus event
+ **************************************************************************/
+ISR(TWI_vect)
+{
+	uint8 status = TWSR & 0xF8;
+	TWI_TransferType *transfer = TWI_Queue[TWI_QueueTail & (TWI_QUEUE_SIZE - 1)];
+
+	switch(status)
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		TWDR = (uint8)((transfer->address << 1) | (TWI_ReadPhase ? 1 : 0));
+		TWCR = TWI_CMD_NEXT;
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		if(TWI_Index < transfer->write_length)
+		{
+			TWDR = transfer->write_buffer[TWI_Index++];
+			TWCR = TWI_CMD_NEXT;
+		}
+		else if(transfer->read_length != 0)
+		{
+			/* write phase is over, address the slave again for reading */
+			TWI_Index = 0;
+			TWI_ReadPhase = TRUE;
+			TWCR = transfer->repeated_start ? TWI_CMD_START : TWI_CMD_STOP_START;
+		}
+		else
+		{
+			TWI_finish(TWI_TRANSFER_DONE, status);
+		}
+		break;
+
+	case TWI_MT_SLA_R_ACK:
+		/* ACK every byte except the last one */
+		TWCR = (transfer->read_length > 1) ? TWI_CMD_NEXT_ACK : TWI_CMD_NEXT;
+		break;
+
+	case TWI_MR_DATA_ACK:
+		transfer->read_buffer[TWI_Index++] = TWDR;
+		TWCR = (TWI_Index < (transfer->read_length - 1)) ? TWI_CMD_NEXT_ACK : TWI_CMD_NEXT;
+		break;
+
+	case TWI_MR_DATA_NACK:
+		transfer->read_buffer[TWI_Index++] = TWDR;
+		TWI_finish(TWI_TRANSFER_DONE, status);
+		break;
+
+	default:
+		/* slave NACK, arbitration lost or bus error, the retry is left to the caller */
+		TWI_finish(TWI_TRANSFER_FAILED, status);
+		break;
+	}
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_submit
+ * Description  : Queue a transfer, the bus is driven from TWI_vect so the
+ *                function returns at once. Interrupts must be enabled.
+ * INPUTS       : transfer (descriptor, must stay alive till it completes)
+ * RETURNS      : boolean (FALSE if the queue is full, transfer is not queued)
+ **************************************************************************/
+boolean TWI_submit(TWI_TransferType *transfer)
+{
+	boolean queued = FALSE;
+	uint8 sreg = SREG;
+
+	/* TWI_vect also moves the queue */
+	SREG &= ~(1 << 7);
+
+	if((uint8)(TWI_QueueHead - TWI_QueueTail) < TWI_QUEUE_SIZE)
+	{
+		transfer->error = 0;
+		TWI_Queue[TWI_QueueHead & (TWI_QUEUE_SIZE - 1)] = transfer;
+
+		if(TWI_QueueHead == TWI_QueueTail)
+		{
+			/* bus is idle, start right away */
+			TWI_beginTransfer(transfer);
+			TWCR = TWI_CMD_START;
+		}
+		else
+		{
+			transfer->status = TWI_TRANSFER_PENDING;
+		}
+
+		TWI_QueueHead++;
+		queued = TRUE;
+	}
+
+	SREG = sreg;
+
+	return queued;
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_checkTimeout
+ * Description  : Abort the transfer on the bus if it exceeded TWI_TIMEOUT_MS,
+ *                the bus is recovered before the next queued transfer starts
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+static void TWI_checkTimeout(void)
+{
+	uint8 sreg = SREG;
+	uint8 error;
+
+	SREG &= ~(1 << 7);
+
+	if((TWI_QueueHead != TWI_QueueTail) && TICK_isExpired(TWI_StartTime + TWI_TIMEOUT_MS))
+	{
+		/* switch the module off, TWI_vect will not fire for this transfer any more.
+		 * The transfer stays at the queue tail during the recovery so TWI_submit
+		 * only queues behind it */
+		error = TWI_getStatus();
+		TWCR = 0;
+		SREG = sreg;
+
+		TWI_recoverBus();
+
+		SREG &= ~(1 << 7);
+		TWI_finish(TWI_TRANSFER_TIMEOUT, error);
+	}
+
+	SREG = sreg;
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_transfer
+ * Description  : Queue a transfer and wait for its completion, interrupts
+ *                (UART, timers, ..) are still served while waiting.
+ *                A failed or timed out transfer is tried again up to
+ *                TWI_MAX_RETRIES times.
+ * INPUTS       : transfer (descriptor)
+ * RETURNS      : TWI_TransferStatus (TWI_TRANSFER_DONE, TWI_TRANSFER_FAILED
+ *                or TWI_TRANSFER_TIMEOUT)
+ **************************************************************************/
+TWI_TransferStatus TWI_transfer(TWI_TransferType *transfer)
+{
+	uint8 attempt;
+
+	for(attempt = 0; attempt <= TWI_MAX_RETRIES; attempt++)
+	{
+		/* wait for a free place in the queue */
+		while(!TWI_submit(transfer))
+		{
+			TWI_checkTimeout();
+		}
+
+		while((transfer->status == TWI_TRANSFER_PENDING) || (transfer->status == TWI_TRANSFER_BUSY))
+		{
+			TWI_checkTimeout();
+		}
+
+		if(transfer->status == TWI_TRANSFER_DONE)
+		{
+			break;
+		}
+	}
+
+	return transfer->status;
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_isBusy
+ * Description  : check if a transfer is on the bus or waiting in the queue,
+ *                a transfer stuck longer than TWI_TIMEOUT_MS is aborted here
+ *                so users of TWI_submit must keep calling it till completion
+ * INPUTS       : void
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean TWI_isBusy(void)
+{
+	TWI_checkTimeout();
+
+	return (TWI_QueueHead != TWI_QueueTail);
+}
+
+
+
+/**************************************************************************
+ * Function Name: TWI_recoverBus
+ * Description  : Free a bus held by a slave: clock SCL up to 9 times till the
+ *                slave releases SDA, then send a STOP by hand and re-enable
+ *                the module. Must only be called while no transfer is running.
+ * INPUTS       : void
+ * RETURNS      : boolean (TRUE if SDA is released)
+ **************************************************************************/
+boolean TWI_recoverBus(void)
+{
+	uint8 i;
+	boolean released;
+
+	/* take the pins from the module, the lines are driven open drain:
+	 * output low pulls the line down, input releases it to the external pull up
+	 */
+	TWCR = 0;
+	GPIO_writePin(TWI_PORT_ID, TWI_SCL_PIN_ID, LOGIC_LOW);
+	GPIO_writePin(TWI_PORT_ID, TWI_SDA_PIN_ID, LOGIC_LOW);
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SDA_PIN_ID, PIN_INPUT);
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SCL_PIN_ID, PIN_INPUT);
+
+	/* a slave stopped in the middle of a byte keeps SDA low till it has
+	 * shifted out the rest of the byte and its ACK, 9 clocks at most
+	 */
+	for(i = 0; (i < 9) && (GPIO_readPin(TWI_PORT_ID, TWI_SDA_PIN_ID) == LOGIC_LOW); i++)
+	{
+		GPIO_setupPinDirection(TWI_PORT_ID, TWI_SCL_PIN_ID, PIN_OUTPUT);
+		_delay_us(5);
+		GPIO_setupPinDirection(TWI_PORT_ID, TWI_SCL_PIN_ID, PIN_INPUT);
+		_delay_us(5);
+	}
+
+	/* STOP condition, SDA goes high while SCL is high */
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SCL_PIN_ID, PIN_OUTPUT);
+	_delay_us(5);
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SDA_PIN_ID, PIN_OUTPUT);
+	_delay_us(5);
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SCL_PIN_ID, PIN_INPUT);
+	_delay_us(5);
+	GPIO_setupPinDirection(TWI_PORT_ID, TWI_SDA_PIN_ID, PIN_INPUT);
+	_delay_us(5);
+
+	released = (GPIO_readPin(TWI_PORT_ID, TWI_SDA_PIN_ID) == LOGIC_HIGH);
+
+	/* give the pins back to the module */
+	TWCR = (1 << TWEN);
+
+	return released;
 }
 
 
@@ -54,7 +402,7 @@ void TWI_start(void)
 	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
 
 	/* wait until the start condition is sent */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitFlag();
 }
 
 
@@ -89,7 +437,7 @@ void TWI_writeByte(uint8 data)
 	/* clear the interrupt flag and enable the module */
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* wait until the operation is completed */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitFlag();
 
 }
 
@@ -108,7 +456,7 @@ uint8 TWI_readByteWithACK(void)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN)| (1 << TWEA) ;
 	/* wait until the action is done */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitFlag();
 	return TWDR;
 }
 
@@ -125,7 +473,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* wait until the action is done */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitFlag();
 	return TWDR;
 
 }
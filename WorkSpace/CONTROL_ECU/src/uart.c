@@ -6,22 +6,56 @@
  *==========================================================================================*/
 
 #include "uart.h"
+#include "tick.h"
+#include "isr_hooks.h"
 
 /*******************************************************************************
  *                               Global_Variables Declaration                             *
  *******************************************************************************/
- 
- 
+
 /********************************************************************************
- * Global Array of 3 pointers to function
- * 1.static to use in this file and hold his value
- * 2.volatile to use in ISRs function and in the function 'TIMER1_Set_CallBack'
- * 3.Initial value with Null or use NULL_Ptr in standard_types
- * USART_TXC_vect     : INDEX 0
- * USART_RXC_vect     : INDEX 1
- * USART_UDRE_vect    : INDEX 2
+ * UBRR settings of each UART_BaudRate profile, all calculated at compile time
  *********************************************************************************/
-static volatile void (*UART_CallBack_Array[3])(void);
+typedef struct
+{
+	uint16 ubrr;
+	uint8 u2x;
+	uint8 supported;
+}UART_BaudSettingType;
+
+static const UART_BaudSettingType UART_BaudTable[UART_BAUD_PROFILES_NUM] =
+{
+	{UART_UBRR(9600UL),   UART_USE_U2X(9600UL),   UART_BAUD_SUPPORTED(9600UL)},
+	{UART_UBRR(38400UL),  UART_USE_U2X(38400UL),  UART_BAUD_SUPPORTED(38400UL)},
+	{UART_UBRR(115200UL), UART_USE_U2X(115200UL), UART_BAUD_SUPPORTED(115200UL)},
+	{UART_UBRR(250000UL), UART_USE_U2X(250000UL), UART_BAUD_SUPPORTED(250000UL)},
+};
+
+/* set once a byte is written to UDR, so UART_flush knows TXC is meaningful */
+static volatile boolean UART_TxStarted = FALSE;
+
+/* receive error counters, updated from USART_RXC_vect (or UART_read in polling mode) */
+static volatile UART_StatsType UART_Stats;
+
+
+#if (UART_USE_INTERRUPT)
+
+/********************************************************************************
+ * RX/TX Ring Buffers
+ * Single producer / single consumer, so no locking is needed:
+ * RX : Head is only moved by USART_RXC_vect, Tail only by UART_read
+ * TX : Head is only moved by UART_write,  Tail only by USART_UDRE_vect
+ * The indices are free running uint8 counters, (Head - Tail) is the fill level
+ *********************************************************************************/
+static volatile uint8 UART_RxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 UART_RxHead = 0;
+static volatile uint8 UART_RxTail = 0;
+
+static volatile uint8 UART_TxBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 UART_TxHead = 0;
+static volatile uint8 UART_TxTail = 0;
+
+#endif
 
 
 /*******************************************************************************
@@ -30,39 +64,111 @@ static volatile void (*UART_CallBack_Array[3])(void);
 
 
 
-#if (0)
+/**************************************************************************
+ * Function Name: UART_checkErrors
+ * Description  : Count the receive errors flagged in UCSRA for the byte in UDR
+ * INPUTS       : status (UCSRA, read before UDR)
+ * RETURNS      : boolean (FALSE if the byte is corrupted and must be dropped)
+ **************************************************************************/
+static boolean UART_checkErrors(uint8 status)
+{
+	boolean valid = TRUE;
+
+	/* bytes were lost before this one, but this one is fine */
+	if(status & (1 << DOR))
+	{
+		UART_Stats.overrun_errors++;
+	}
+
+	if(status & (1 << FE))
+	{
+		UART_Stats.framing_errors++;
+		valid = FALSE;
+	}
+
+	if(status & (1 << PE))
+	{
+		UART_Stats.parity_errors++;
+		valid = FALSE;
+	}
+
+	return valid;
+}
+
+
+
+#if (UART_USE_INTERRUPT)
 /*********** In case of Using Interrupt ***************/
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR USART_TXC_vect)
- * Description  : Call the Function that is required to be Executed when 
-                  USART_TXC_vect happens [Transmit Complete] 
+ * Description  : Execute the handler bound to UART_TX_COMPLETE in isr_hooks.h
+ *                [Transmit Complete]
  **************************************************************************/
+#ifdef UART_TX_COMPLETE_HOOK
 ISR(USART_TXC_vect)
 {
-	(*UART_CallBack_Array[0])();
+	UART_TX_COMPLETE_HOOK();
 }
+#else
+EMPTY_INTERRUPT(USART_TXC_vect)
+#endif
 
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR USART_RXC_vect)
- * Description  : Call the Function that is required to be Executed when 
-                  USART_RXC_vect happens [Receive Complete] 
+ * Description  : Move the received byte from UDR into the RX ring buffer,
+ *                the byte is dropped if it is corrupted or the buffer is full,
+ *                then execute the handler bound to UART_RX in isr_hooks.h
  **************************************************************************/
 ISR(USART_RXC_vect)
 {
-	(*UART_CallBack_Array[1])();
+	/* error flags belong to the byte in UDR, so UCSRA must be read first */
+	uint8 status = UCSRA;
+	uint8 data = UDR;
+	uint8 head = UART_RxHead;
+
+	if(UART_checkErrors(status) == FALSE)
+	{
+		return;
+	}
+
+	if((uint8)(head - UART_RxTail) < UART_RX_BUFFER_SIZE)
+	{
+		UART_RxBuffer[head & (UART_RX_BUFFER_SIZE - 1)] = data;
+		UART_RxHead = head + 1;
+	}
+	else
+	{
+		UART_Stats.buffer_overruns++;
+	}
+
+#ifdef UART_RX_HOOK
+	UART_RX_HOOK();
+#endif
 }
 
 
 /**************************************************************************
  * Function Name: ISR (INTERRUPT HANDLER FOR USART_UDRE_vect)
- * Description  : Call the Function that is required to be Executed when 
-                  USART_UDRE_vect happens [UDR is Empty ] 
+ * Description  : Feed UDR with the next byte of the TX ring buffer,
+ *                disable the interrupt when the buffer is drained
  **************************************************************************/
 ISR(USART_UDRE_vect)
 {
-	(*UART_CallBack_Array[2])();
+	uint8 tail = UART_TxTail;
+
+	if(tail != UART_TxHead)
+	{
+		UDR = UART_TxBuffer[tail & (UART_TX_BUFFER_SIZE - 1)];
+		UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC); /* clear TXC by writing one, FE/DOR/PE written zero */
+		UART_TxTail = tail + 1;
+		UART_TxStarted = TRUE;
+	}
+	else
+	{
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
 }
 /*********** In case of Using Interrupt ***************/
 
@@ -76,11 +182,16 @@ ISR(USART_UDRE_vect)
  **************************************************************************/
 void UART_init(const UART_ConfigType* Config_Ptr)
 {
-	uint16 UBRR_value = 0;
+	UART_TxStarted = FALSE;
 
-	UCSRA = (1 << U2X);             /*Double Speed Mode */
+#if (UART_USE_INTERRUPT)
+	UART_RxHead = UART_RxTail = 0;
+	UART_TxHead = UART_TxTail = 0;
 
+	UCSRB = (1<<RXEN) | (1<<TXEN) | (1<<RXCIE); /* Enable the UART TX/RX and RX Complete Interrupt */
+#else
 	UCSRB = (1<<RXEN) | (1<<TXEN); /* Enable the UART TX/RX */
+#endif
 
 	/*
 	 * 8-bit character Data
@@ -88,15 +199,8 @@ void UART_init(const UART_ConfigType* Config_Ptr)
 	 */
 	UCSRC = (1<<URSEL) | (Config_Ptr->bit_data << 1 ) |(Config_Ptr->parity << 4) | (Config_Ptr->stop_bit << 3);
 
-	/* Calculate the UBRR register value */
-	UBRR_value = (uint16)(((F_CPU / (Config_Ptr->baud_rate* 8UL))) - 1);
-
-	/* second 8 bits of the ubrr_value are set in UBRRH Register */
-	UBRRH =(uint8)(UBRR_value >> 8);
-
-	/* first 8 bits of the ubrr_value are set in UBRRL Register */
-	UBRRL =(uint8)UBRR_value;
-
+	/* UBRR value is taken from the compile time table, no division at runtime */
+	UART_setBaudRate(Config_Ptr->baud_rate);
 }
 
 
@@ -109,9 +213,8 @@ void UART_init(const UART_ConfigType* Config_Ptr)
  **************************************************************************/
 void UART_sendByte(uint8 data)
 {
-	/* check if the UDR is Ready to write in or not */
-	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
-	UDR = data;
+	/* wait until there is a room for the byte */
+	while(UART_write(&data,1) == 0){}
 }
 
 
@@ -124,12 +227,38 @@ void UART_sendByte(uint8 data)
  **************************************************************************/
 uint8 UART_recieveByte(void)
 {
+	uint8 data;
+
 	/* make sure the receive is complete */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
-	return 	UDR;
+	while(UART_read(&data,1) == 0){}
+	return 	data;
 }
 
 
+/**************************************************************************
+ * Function Name: UART_recieveByteTimeout
+ * Description  : a function to receive a character with a bounded wait,
+ *                the wait is measured with the shared millisecond tick
+ * INPUTS       : data (where the received byte is saved), timeout_ms (max wait)
+ * RETURNS      : UART_StatusType (UART_OK or UART_TIMEOUT, data is untouched on timeout)
+ **************************************************************************/
+UART_StatusType UART_recieveByteTimeout(uint8 *data, uint16 timeout_ms)
+{
+	uint32 deadline = TICK_getMs() + timeout_ms;
+
+	while(UART_read(data,1) == 0)
+	{
+		if(TICK_isExpired(deadline))
+		{
+			return UART_TIMEOUT;
+		}
+	}
+
+	return UART_OK;
+}
+
+
+
 /**************************************************************************
  * Function Name: UART_sendString
  * Description  : a function to send a string as whole packet not a character by character
@@ -168,13 +297,195 @@ void UART_receiveString(uint8* str)
 
 
 
-/**********************************************************************************
- * Function Name: UART_setCallBack
- * Description  : A Function to set the callBack functions for UART Events
- * INPUTS       : ptr_2_fun,index(which indicates which ISR would be Executed)
+/**************************************************************************
+ * Function Name: UART_write
+ * Description  : Non-blocking write, copies as many bytes as there is room for
+ *                in the TX ring buffer (or as UDR accepts in polling mode)
+ * INPUTS       : data (bytes to be sent), len (number of bytes)
+ * RETURNS      : uint8 (number of bytes actually queued)
+ **************************************************************************/
+uint8 UART_write(const uint8 *data, uint8 len)
+{
+	uint8 count = 0;
+
+#if (UART_USE_INTERRUPT)
+	uint8 head = UART_TxHead;
+
+	while((count < len) && ((uint8)(head - UART_TxTail) < UART_TX_BUFFER_SIZE))
+	{
+		UART_TxBuffer[head & (UART_TX_BUFFER_SIZE - 1)] = data[count];
+		head++;
+		count++;
+	}
+
+	if(count != 0)
+	{
+		/* publish the new bytes then let USART_UDRE_vect drain them */
+		UART_TxHead = head;
+		SET_BIT(UCSRB,UDRIE);
+	}
+#else
+	while((count < len) && BIT_IS_SET(UCSRA,UDRE))
+	{
+		UDR = data[count];
+		UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC); /* clear TXC by writing one, FE/DOR/PE written zero */
+		UART_TxStarted = TRUE;
+		count++;
+	}
+#endif
+
+	return count;
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_read
+ * Description  : Non-blocking read, takes as many bytes as are already received
+ *                up to len
+ * INPUTS       : data (buffer to save the received bytes in), len (buffer size)
+ * RETURNS      : uint8 (number of bytes actually read)
+ **************************************************************************/
+uint8 UART_read(uint8 *data, uint8 len)
+{
+	uint8 count = 0;
+
+#if (UART_USE_INTERRUPT)
+	uint8 tail = UART_RxTail;
+
+	while((count < len) && (tail != UART_RxHead))
+	{
+		data[count] = UART_RxBuffer[tail & (UART_RX_BUFFER_SIZE - 1)];
+		tail++;
+		count++;
+	}
+
+	/* release the slots to USART_RXC_vect */
+	UART_RxTail = tail;
+#else
+	uint8 status;
+
+	while((count < len) && BIT_IS_SET(UCSRA,RXC))
+	{
+		status = UCSRA;
+		data[count] = UDR;
+		if(UART_checkErrors(status) == TRUE)
+		{
+			count++;
+		}
+	}
+#endif
+
+	return count;
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_setBaudRate
+ * Description  : Switch to another baud rate profile, the pending TX bytes
+ *                are sent first with the old rate
+ * INPUTS       : baud_rate (the new profile)
+ * RETURNS      : boolean (FALSE if the profile is not supported at this F_CPU)
+ **************************************************************************/
+boolean UART_setBaudRate(UART_BaudRate baud_rate)
+{
+	const UART_BaudSettingType *setting;
+
+	if(UART_isBaudRateSupported(baud_rate) == FALSE)
+	{
+		return FALSE;
+	}
+	setting = &UART_BaudTable[baud_rate];
+
+	UART_flush();
+
+	/* Double Speed Mode if it gives the smaller error */
+	UCSRA = (setting->u2x) ? (1 << U2X) : 0;
+
+	/* second 8 bits of the ubrr value are set in UBRRH Register (URSEL = 0) */
+	UBRRH = (uint8)(setting->ubrr >> 8);
+
+	/* first 8 bits of the ubrr value are set in UBRRL Register */
+	UBRRL = (uint8)setting->ubrr;
+
+	return TRUE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_isBaudRateSupported
+ * Description  : Check if a baud rate profile is within 2% error at this F_CPU
+ * INPUTS       : baud_rate (the profile to be checked)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean UART_isBaudRateSupported(UART_BaudRate baud_rate)
+{
+	return (baud_rate < UART_BAUD_PROFILES_NUM) && UART_BaudTable[baud_rate].supported;
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_getSupportedBaudRates
+ * Description  : Get all the profiles supported at this F_CPU, used by the
+ *                link handshake to find the fastest rate both ECUs support
+ * INPUTS       : void
+ * RETURNS      : uint8 (bit n is set if profile n is supported)
+ **************************************************************************/
+uint8 UART_getSupportedBaudRates(void)
+{
+	uint8 mask = 0;
+	uint8 i;
+
+	for(i = 0; i < UART_BAUD_PROFILES_NUM; i++)
+	{
+		if(UART_BaudTable[i].supported)
+		{
+			mask |= (1 << i);
+		}
+	}
+
+	return mask;
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_flush
+ * Description  : Wait until all the queued bytes are completely shifted out
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void UART_flush(void)
+{
+#if (UART_USE_INTERRUPT)
+	/* wait for USART_UDRE_vect to drain the TX ring buffer */
+	while(UART_TxHead != UART_TxTail){}
+#endif
+
+	/* wait for the last byte to leave the shift register */
+	if(UART_TxStarted)
+	{
+		while(BIT_IS_CLEAR(UCSRA,TXC)){}
+	}
+}
+
+
+
+/**************************************************************************
+ * Function Name: UART_getStats
+ * Description  : Get a consistent copy of the receive error counters
+ * INPUTS       : stats (where the counters are saved)
  * RETURNS      : void
- **********************************************************************************/
-void UART_setCallBack(void (*ptr_2_func)(void),uint8 index)
+ **************************************************************************/
+void UART_getStats(UART_StatsType *stats)
 {
-	UART_CallBack_Array[index] = ptr_2_func;
+	uint8 sreg = SREG;
+
+	/* counters are 16-bit and updated by USART_RXC_vect */
+	SREG &= ~(1 << 7);
+	*stats = UART_Stats;
+	SREG = sreg;
 }
@@ -0,0 +1,395 @@
+/*===========================================================================================
+ * Filename   : users.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the multi-user credential table in the external EEPROM
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "users.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* offsets in the DATA of a record */
+#define USERS_FLAGS_OFFSET    (0U)
+#define USERS_DIGEST_OFFSET   (1U)
+
+/* index entries that do not point to a record */
+#define USERS_EMPTY           (0xFFU)	/* never used, ends a probe sequence */
+#define USERS_DELETED         (0xFEU)	/* revoked user, the probe sequence goes on */
+
+/* USERS_init reads the table by this many records at a time */
+#define USERS_READ_CHUNK      (4U)
+
+/* FNV-1a 32-bit */
+#define USERS_FNV_OFFSET      (2166136261UL)
+#define USERS_FNV_PRIME       (16777619UL)
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* the tag is the top byte of the digest, it filters the records to read */
+typedef struct
+{
+	uint8 tag;
+	uint8 slot;
+}USERS_IndexEntryType;
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+static USERS_IndexEntryType USERS_Index[USERS_INDEX_SIZE];
+
+/* FLAGS of every record, 0 for a free record, so listing needs no EEPROM access */
+static uint8 USERS_Flags[USERS_MAX];
+
+/* set once the whole table is read, a free record of a partly read table
+ * may be the one of an active user
+ */
+static boolean USERS_Loaded = FALSE;
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: USERS_digest
+ * Description  : FNV-1a hash of a PIN
+ * INPUTS       : pin && length
+ * RETURNS      : uint32 (digest)
+ **************************************************************************/
+static uint32 USERS_digest(const uint8 *pin, uint8 length)
+{
+	uint32 digest = USERS_FNV_OFFSET;
+	uint8 i;
+
+	for(i = 0; i < length; i++)
+	{
+		digest ^= pin[i];
+		digest *= USERS_FNV_PRIME;
+	}
+
+	return digest;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_offset
+ * Description  : Offset of a record in the USERS region
+ * INPUTS       : slot (record number, user ID - 1)
+ * RETURNS      : uint16
+ **************************************************************************/
+static uint16 USERS_offset(uint8 slot)
+{
+	return (uint16)slot * USERS_RECORD_SIZE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_writeRecord
+ * Description  : Update a record, only its older copy is written (one page
+ *                write) so the previous value survives a reset
+ * INPUTS       : slot, flags, digest
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+static uint8 USERS_writeRecord(uint8 slot, uint8 flags, uint32 digest)
+{
+	uint8 data[USERS_DATA_SIZE];
+	uint8 i;
+
+	data[USERS_FLAGS_OFFSET] = flags;
+	for(i = 0; i < 4; i++)
+	{
+		data[USERS_DIGEST_OFFSET + i] = (uint8)(digest >> (8 * i));
+	}
+
+	return EEPROM_writeRecord(LAYOUT_ADDRESS(USERS, USERS_offset(slot)), data, USERS_DATA_SIZE);
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_parseRecord
+ * Description  : Pick the newest valid copy of a record read from the
+ *                EEPROM and extract its fields
+ * INPUTS       : record (both copies), flags && digest
+ * RETURNS      : boolean (FALSE for an erased or corrupted record)
+ **************************************************************************/
+static boolean USERS_parseRecord(const uint8 *record, uint8 *flags, uint32 *digest)
+{
+	uint8 i;
+
+	record = EEPROM_selectRecord(record, USERS_DATA_SIZE);
+	if(record == NULL_PTR)
+	{
+		return FALSE;
+	}
+
+	*flags = record[USERS_FLAGS_OFFSET];
+	*digest = 0;
+	for(i = 0; i < 4; i++)
+	{
+		*digest |= ((uint32)record[USERS_DIGEST_OFFSET + i] << (8 * i));
+	}
+
+	return TRUE;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_insert
+ * Description  : Add a record to the index, linear probing from the slot
+ *                given by the low bits of the digest
+ * INPUTS       : digest, slot
+ * RETURNS      : void
+ **************************************************************************/
+static void USERS_insert(uint32 digest, uint8 slot)
+{
+	uint8 position = (uint8)(digest & (USERS_INDEX_SIZE - 1));
+
+	/* the index is at most half full so a free entry is always found */
+	while((USERS_Index[position].slot != USERS_EMPTY) && (USERS_Index[position].slot != USERS_DELETED))
+	{
+		position = (position + 1) & (USERS_INDEX_SIZE - 1);
+	}
+
+	USERS_Index[position].tag = (uint8)(digest >> 24);
+	USERS_Index[position].slot = slot;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_init
+ * Description  : Read the whole table with a few sequential block reads and
+ *                build the SRAM index of the active users. Till it succeeds
+ *                the users can not be added or revoked
+ * INPUTS       : void
+ * RETURNS      : uint8 (SUCCESS or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_init(void)
+{
+	uint8 chunk[USERS_READ_CHUNK * USERS_RECORD_SIZE];
+	uint8 status;
+	uint8 flags;
+	uint32 digest;
+	uint8 slot;
+	uint8 i;
+
+	USERS_Loaded = FALSE;
+	for(i = 0; i < USERS_INDEX_SIZE; i++)
+	{
+		USERS_Index[i].slot = USERS_EMPTY;
+	}
+
+	for(slot = 0; slot < USERS_MAX; slot++)
+	{
+		/* sequential reads of a few records, to keep the stack small */
+		if((slot % USERS_READ_CHUNK) == 0)
+		{
+			status = LAYOUT_read(USERS, USERS_offset(slot), chunk, sizeof(chunk));
+			if(status != SUCCESS)
+			{
+				return status;
+			}
+		}
+
+		USERS_Flags[slot] = 0;
+		if((USERS_parseRecord(&chunk[(slot % USERS_READ_CHUNK) * USERS_RECORD_SIZE], &flags, &digest) == TRUE) &&
+		   (flags & USERS_FLAG_ACTIVE))
+		{
+			USERS_Flags[slot] = flags;
+			USERS_insert(digest, slot);
+		}
+	}
+
+	USERS_Loaded = TRUE;
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_find
+ * Description  : Find the active user of a PIN, the index gives the record
+ *                so it is normally a single block read of one record
+ *                (one more per user whose digest shares the 8-bit tag)
+ * INPUTS       : pin && length, user_id && flags (of the user found)
+ * RETURNS      : uint8 (SUCCESS, USERS_NOT_FOUND or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_find(const uint8 *pin, uint8 length, uint8 *user_id, uint8 *flags)
+{
+	uint8 record[USERS_RECORD_SIZE];
+	uint32 digest = USERS_digest(pin, length);
+	uint32 stored_digest;
+	uint8 position = (uint8)(digest & (USERS_INDEX_SIZE - 1));
+	uint8 slot;
+	uint8 status;
+	uint8 i;
+
+	for(i = 0; i < USERS_INDEX_SIZE; i++)
+	{
+		slot = USERS_Index[position].slot;
+		if(slot == USERS_EMPTY)
+		{
+			break;
+		}
+
+		if((slot != USERS_DELETED) && (USERS_Index[position].tag == (uint8)(digest >> 24)))
+		{
+			status = LAYOUT_read(USERS, USERS_offset(slot), record, USERS_RECORD_SIZE);
+			if(status != SUCCESS)
+			{
+				return status;
+			}
+
+			if((USERS_parseRecord(record, flags, &stored_digest) == TRUE) &&
+			   (*flags & USERS_FLAG_ACTIVE) && (stored_digest == digest))
+			{
+				*user_id = slot + 1;
+				return SUCCESS;
+			}
+		}
+
+		position = (position + 1) & (USERS_INDEX_SIZE - 1);
+	}
+
+	return USERS_NOT_FOUND;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_add
+ * Description  : Store a new user in the first free record
+ * INPUTS       : pin && length, flags (USERS_FLAG_ADMIN or 0),
+ *                user_id (ID given to the new user)
+ * RETURNS      : uint8 (SUCCESS, USERS_FULL, USERS_DUPLICATE, USERS_NOT_LOADED
+ *                or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_add(const uint8 *pin, uint8 length, uint8 flags, uint8 *user_id)
+{
+	uint8 existing_id;
+	uint8 existing_flags;
+	uint8 status;
+	uint8 slot;
+
+	if(USERS_Loaded == FALSE)
+	{
+		return USERS_NOT_LOADED;
+	}
+
+	/* the PIN alone identifies the user at the door, it must be unique */
+	status = USERS_find(pin, length, &existing_id, &existing_flags);
+	if(status == SUCCESS)
+	{
+		return USERS_DUPLICATE;
+	}
+	else if(status != USERS_NOT_FOUND)
+	{
+		return status;
+	}
+
+	for(slot = 0; slot < USERS_MAX; slot++)
+	{
+		if(USERS_Flags[slot] == 0)
+		{
+			break;
+		}
+	}
+
+	if(slot == USERS_MAX)
+	{
+		return USERS_FULL;
+	}
+
+	flags = (flags & USERS_FLAG_ADMIN) | USERS_FLAG_ACTIVE;
+	status = USERS_writeRecord(slot, flags, USERS_digest(pin, length));
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	USERS_Flags[slot] = flags;
+	USERS_insert(USERS_digest(pin, length), slot);
+	*user_id = slot + 1;
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_revoke
+ * Description  : Remove a user, its record is kept but marked not active
+ * INPUTS       : user_id
+ * RETURNS      : uint8 (SUCCESS, USERS_NOT_FOUND, USERS_NOT_LOADED or the EEPROM status)
+ **************************************************************************/
+uint8 USERS_revoke(uint8 user_id)
+{
+	uint8 slot = user_id - 1;
+	uint8 status;
+	uint8 i;
+
+	if(USERS_Loaded == FALSE)
+	{
+		return USERS_NOT_LOADED;
+	}
+
+	if((user_id == 0) || (user_id > USERS_MAX) || (USERS_Flags[slot] == 0))
+	{
+		return USERS_NOT_FOUND;
+	}
+
+	/* the digest is wiped too, nothing of the PIN is left behind */
+	status = USERS_writeRecord(slot, 0, 0);
+	if(status != SUCCESS)
+	{
+		return status;
+	}
+
+	USERS_Flags[slot] = 0;
+	for(i = 0; i < USERS_INDEX_SIZE; i++)
+	{
+		if(USERS_Index[i].slot == slot)
+		{
+			USERS_Index[i].slot = USERS_DELETED;
+			break;
+		}
+	}
+
+	return SUCCESS;
+}
+
+
+
+/**************************************************************************
+ * Function Name: USERS_getNext
+ * Description  : Walk the active users in ID order
+ * INPUTS       : user_id (first ID to look at, 1 to start), flags
+ * RETURNS      : uint8 (ID of the next active user, 0 when there is none)
+ **************************************************************************/
+uint8 USERS_getNext(uint8 user_id, uint8 *flags)
+{
+	uint8 slot;
+
+	for(slot = (user_id == 0) ? 0 : (user_id - 1); slot < USERS_MAX; slot++)
+	{
+		if(USERS_Flags[slot] != 0)
+		{
+			*flags = USERS_Flags[slot];
+			return slot + 1;
+		}
+	}
+
+	return 0;
+}
@@ -1,25 +0,0 @@
-################################################################################
-# Automatically-generated file. Do not edit!
-################################################################################
-
-OBJ_SRCS := 
-S_SRCS := 
-ASM_SRCS := 
-C_SRCS := 
-S_UPPER_SRCS := 
-O_SRCS := 
-FLASH_IMAGE := 
-ELFS := 
-OBJS := 
-ASM_DEPS := 
-EEPROM_IMAGE := 
-S_DEPS := 
-SIZEDUMMY := 
-S_UPPER_DEPS := 
-LSS := 
-C_DEPS := 
-
-# Every subdirectory with source files must be described here
-SUBDIRS := \
-. \
-
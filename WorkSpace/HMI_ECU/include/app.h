@@ -9,8 +9,60 @@
 #define APP_H_
 
 #include "std_types.h"
+#include "frame.h"
 
 
+/*******************************************************************************
+ *                      Definitions                                            *
+ *******************************************************************************/
+
+/* wait for each try of a request, and the extra tries before giving up */
+#define  APP_RESPONSE_TIMEOUT_MS    500
+#define  APP_REQUEST_RETRIES        2
+
+/* wait for an answer at each baud rate while looking for Control_ECU */
+#define  APP_PROBE_TIMEOUT_MS       50
+
+/* the keypad is scanned, and the door state of Control_ECU is polled, this often (in ms) */
+#define  APP_KEYPAD_SCAN_MS         (20UL)
+#define  APP_DOOR_POLL_MS           (1000UL)
+
+/* door polls in a row without an answer before the door screen is left */
+#define  APP_DOOR_POLL_TRIES        3
+
+/* lockout time, and how long a message stays on the LCD (in ms) */
+#define  APP_LOCKOUT_MS             (60000UL)
+#define  APP_MESSAGE_MS             (1000UL)
+
+/* the ON key ends an entry, which takes at most PASSWORD_MAX_LENGTH keys */
+#define  APP_KEY_ENTER              13
+#define  PASSWORD_MAX_LENGTH        9
+
+/* wrong passwords before the system is locked */
+#define  APP_PASSWORD_TRIALS        3
+
+/* pages of the link counters of one ECU */
+#define  APP_STATS_PAGES            4
+
+/* the remaining seconds of a door stage or lockout are shown at this column of row 1 */
+#define  APP_COUNTDOWN_COLUMN       13
+
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* what the LCD shows, it tells what a key press does */
+typedef enum
+{
+	SCREEN_MENU, SCREEN_MESSAGE, SCREEN_NEW_PASS, SCREEN_CONFIRM_PASS, SCREEN_PASSWORD,
+	SCREEN_ADMIN_MENU, SCREEN_NEW_USER_PIN, SCREEN_NEW_USER_ROLE, SCREEN_USER_ID,
+	SCREEN_USERS, SCREEN_AUDIT, SCREEN_STATS, SCREEN_DOOR, SCREEN_LOCKED
+}APP_ScreenType;
+
+/* the screen shown once a message ends */
+typedef void (*APP_ActionType)(void);
+
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -18,9 +70,120 @@
 
 
 /**************************************************************************
- * Function Name: setPassword
+ * Function Name: APP_init
+ * Description  : This function is responsible for initializing the peripherals
+ *                (LCD && UART) and finding Control_ECU on the link
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void APP_init(void);
+
+
+/**************************************************************************
+ * Function Name: APP_start
+ * Description  : Show the main menu, or ask for the first password if
+ *                Control_ECU has none stored, and start scanning the
+ *                keypad, then SCHEDULER_run takes over
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void APP_start(void);
+
+
+/**************************************************************************
+ * Function Name: showMenu
+ * Description  : Display main system options, the keys now select one
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showMenu(void);
+
+
+/**************************************************************************
+ * Function Name: scanKeypad
+ * Description  : Callback of the keypad timer, post the key task when a
+ *                key is pressed (once per press)
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void scanKeypad(void);
+
+
+/**************************************************************************
+ * Function Name: handleKey
+ * Description  : Key task, act on the pressed key as the screen says. Every
+ *                screen takes one key and returns, so the timers and the
+ *                other tasks run between two keys
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void handleKey(void);
+
+
+/**************************************************************************
+ * Function Name: selectOption
+ * Description  : Run the main menu option of a key, the ones that need the
+ *                password ask for it first
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void selectOption(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: runOption
+ * Description  : Run the menu option the password was asked for
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void runOption(void);
+
+
+/**************************************************************************
+ * Function Name: showMessage
+ * Description  : Show a message for APP_MESSAGE_MS, the keys are ignored
+ *                meanwhile, then the next screen is shown
+ * INPUTS       : row0 && row1 (text of the two rows), next (shows the next screen)
+ * RETURNS      : void
+ **************************************************************************/
+void showMessage(const char *row0, const char *row1, APP_ActionType next);
+
+
+/**************************************************************************
+ * Function Name: endMessage
+ * Description  : Callback of the display timer, the message ends
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void endMessage(void);
+
+
+/**************************************************************************
+ * Function Name: startEntry
+ * Description  : Show a prompt and wait for the keys of an entry, each key
+ *                is taken by the entry screen till the ON key ends it
+ * INPUTS       : title (row 0), prompt (row 1, the keys follow it),
+ *                entry_screen (screen that takes the keys)
+ * RETURNS      : void
+ **************************************************************************/
+void startEntry(const char *title, const char *prompt, APP_ScreenType entry_screen);
+
+
+/**************************************************************************
+ * Function Name: enterKey
+ * Description  : Add a key to the entry, a secret key is shown as '*' and
+ *                any key is taken, else only the digits are taken and shown.
+ *                The keys after PASSWORD_MAX_LENGTH are ignored
+ * INPUTS       : key, secret
+ * RETURNS      : boolean (TRUE once the ON key ends the entry)
+ **************************************************************************/
+boolean enterKey(uint8 key, boolean secret);
+
+
+/**************************************************************************
+ * Function Name: setPass
  * Description  : This function is responsible for setting and updating
- *                the password of the system
+ *                the password of the system, it asks for the new password
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
@@ -28,26 +191,70 @@ void setPass(void);
 
 
 /**************************************************************************
- * Function Name: checkPassword_trials
- * Description  : This function is responsible for prompting the user for correct passwords,
- * 		          within maximum 3 times.
+ * Function Name: enterNewPass
+ * Description  : Key of the new password, or of its confirmation. The
+ *                password is sent to Control_ECU once both match, else
+ *                it is asked from the beginning
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterNewPass(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: askPassword
+ * Description  : Prompt the user for the system password
  * INPUTS       : void
- * RETURNS      : uint8
- *                1 Password is correct.
- * 		   	      0 All trials are used without password being correct
+ * RETURNS      : void
+ **************************************************************************/
+void askPassword(void);
+
+
+/**************************************************************************
+ * Function Name: enterPassword
+ * Description  : Key of the system password, once entered it is checked
+ *                by Control_ECU (and the user table). A correct one runs
+ *                the pending option, a wrong one uses a trial and the
+ *                system is locked after APP_PASSWORD_TRIALS. A timeout or
+ *                a storage error is not a trial, it goes back to the menu
+ * INPUTS       : key
+ * RETURNS      : void
  **************************************************************************/
-uint8 checkPassword_trials(void);
+void enterPassword(uint8 key);
 
 
 /**************************************************************************
  * Function Name: openDoor
- * Description  : This function is responsible for executing the steps required to open the door
+ * Description  : This function is responsible for executing the steps required to open the door,
+ *                Control_ECU runs the door cycle, the door timer polls its
+ *                state and any key aborts it, back to the menu if it is refused
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void openDoor(void);
 
 
+/**************************************************************************
+ * Function Name: postDoorPoll
+ * Description  : Callback of the door timer, post the door task, the
+ *                request is not sent from inside SOFT_TIMER_process
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void postDoorPoll(void);
+
+
+/**************************************************************************
+ * Function Name: pollDoor
+ * Description  : Door task, show the stage of the door
+ *                cycle and the seconds left, back to the menu once it is closed
+ *                or after APP_DOOR_POLL_TRIES polls without an answer
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void pollDoor(void);
+
+
 /**************************************************************************
  * Function Name: lockSystem
  * Description  : This function is responsible for locking the system
@@ -58,86 +265,249 @@ void openDoor(void);
 void lockSystem(void);
 
 
+/**************************************************************************
+ * Function Name: endLockout
+ * Description  : Callback of the lockout timer, back to the menu
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void endLockout(void);
+
 
 /**************************************************************************
- * Function Name: getPass
- * Description  : This function is responsible for storing the user entered password,
- * 		          and printing '*' on LCD instead of each entered character
- * INPUTS       : password array && Size of password passed by address
+ * Function Name: startCountdown
+ * Description  : Show a number of seconds on row 1 and start the display
+ *                timer that counts it down every second
+ * INPUTS       : seconds
  * RETURNS      : void
  **************************************************************************/
-void getPass(uint8 *passArr, uint8 *size);
+void startCountdown(uint8 seconds);
 
 
 /**************************************************************************
- * Function Name: isPassMatched
- * Description  : This function is to compare user entered password && system password
+ * Function Name: countDown
+ * Description  : Callback of the display timer, show one second less
  * INPUTS       : void
- * RETURNS      : uint8
- * 			      1 ==> Passwords match
- * 			      0 ==> Passwords do not match
+ * RETURNS      : void
  **************************************************************************/
+void countDown(void);
 
-uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size);
+
+/**************************************************************************
+ * Function Name: showSeconds
+ * Description  : Show a number of seconds left on row 1
+ * INPUTS       : seconds
+ * RETURNS      : void
+ **************************************************************************/
+void showSeconds(uint8 seconds);
 
 
 /**************************************************************************
- * Function Name: verifyPass_ControlECU
- * Description  : This function is to compare password entered by user to
- *                the saved password of the system
+ * Function Name: adminMenu
+ * Description  : User administration, add a user, revoke a user, list
+ *                the users stored in Control_ECU or read its audit log
  * INPUTS       : void
- * RETURNS      : uint8
- *                '1' Password is correct.
- * 		   	      '0' Password is false.
+ * RETURNS      : void
  **************************************************************************/
-uint8 verifyPass_ControlECU(void);
+void adminMenu(void);
 
 
 /**************************************************************************
- * Function Name: TIMER1_callback_function
- * Description  : The required function to be executed when timer interrupt
- *                is fired, "increments ticks variable"
+ * Function Name: selectAdminOption
+ * Description  : Run the administration option of a key
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void selectAdminOption(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: addUser
+ * Description  : Ask for the PIN of a new user
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_callback_function(void);
+void addUser(void);
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_15sec
- * Description  : This function is to generate 15 seconds delay using timer1.
+ * Function Name: enterNewUserPin
+ * Description  : Key of the PIN of a new user, then ask for its role
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterNewUserPin(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: enterNewUserRole
+ * Description  : Key of the role of a new user, then store it in
+ *                Control_ECU, the new user ID is displayed
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterNewUserRole(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: revokeUser
+ * Description  : Ask for the ID of the user to remove
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_15sec(void);
+void revokeUser(void);
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_3sec
- * Description  : This function is to generate 1 seconds delay using timer1.
+ * Function Name: enterUserId
+ * Description  : Digit of a user ID, the ON key ends it and that user is
+ *                removed from Control_ECU
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterUserId(uint8 key);
+
+
+/**************************************************************************
+ * Function Name: listUsers
+ * Description  : Display the IDs of the stored users, a page per response
+ *                of Control_ECU, admins are marked with 'A'. Each page stays
+ *                until a key is pressed
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_1sec(void);
+void listUsers(void);
+
 
+/**************************************************************************
+ * Function Name: requestUsers
+ * Description  : Get the next response of the user list and show its first page
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void requestUsers(void);
 
 
 /**************************************************************************
- * Function Name: APP_init
- * Description  : This function is responsible for initializing the peripherals used
+ * Function Name: showUsersPage
+ * Description  : Show the next users of the response, 4 per LCD row
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void APP_init(void);
+void showUsersPage(void);
 
 
 /**************************************************************************
- * Function Name: APP_start
- * Description  : This function is responsible for Running the system as required
+ * Function Name: showAudit
+ * Description  : Read the audit log of Control_ECU from the oldest event,
+ *                one event per page, a key shows the next one and the ON
+ *                key stops
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void APP_start(void);
+void showAudit(void);
+
+
+/**************************************************************************
+ * Function Name: requestAudit
+ * Description  : Get the next events of the audit log and show the first one
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void requestAudit(void);
+
+
+/**************************************************************************
+ * Function Name: showAuditRecord
+ * Description  : Show the next event of the response
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showAuditRecord(void);
+
+
+/**************************************************************************
+ * Function Name: getEventName
+ * Description  : Text of an audit event, at most 16 characters
+ * INPUTS       : event (FRAME_EVENT_xxx)
+ * RETURNS      : const char*
+ **************************************************************************/
+const char* getEventName(uint8 event);
+
+
+/**************************************************************************
+ * Function Name: APP_negotiateBaudRate
+ * Description  : Link speed handshake, find the rate Control_ECU is listening at,
+ *                send it the supported profiles then switch to the profile it answers with.
+ *                One pass over the profiles, it gives up after at most
+ *                UART_BAUD_PROFILES_NUM * APP_PROBE_TIMEOUT_MS
+ * INPUTS       : session (FRAME_SESSION_NEW after a reset of HMI_ECU,
+ *                FRAME_SESSION_RESUMED after a timeout)
+ * RETURNS      : boolean (FALSE if Control_ECU answered at no rate)
+ **************************************************************************/
+boolean APP_negotiateBaudRate(uint8 session);
+
+
+/**************************************************************************
+ * Function Name: APP_request
+ * Description  : Send a request frame to Control_ECU and wait for its response
+ * INPUTS       : opcode (FRAME_OP_xxx), payload && length of the payload
+ * RETURNS      : uint8 (result byte of the response FRAME_RESULT_xxx,
+ *                FRAME_RESULT_TIMEOUT if Control_ECU never answered)
+ **************************************************************************/
+uint8 APP_request(uint8 opcode, const uint8 *payload, uint8 length);
+
+
+/**************************************************************************
+ * Function Name: APP_requestData
+ * Description  : Same as APP_request but the whole response is returned too,
+ *                for requests whose response carries data after the result
+ * INPUTS       : opcode (FRAME_OP_xxx), payload && length of the payload,
+ *                response (where the response frame is saved)
+ * RETURNS      : uint8 (result byte of the response FRAME_RESULT_xxx,
+ *                FRAME_RESULT_TIMEOUT if Control_ECU never answered)
+ **************************************************************************/
+uint8 APP_requestData(uint8 opcode, const uint8 *payload, uint8 length, FRAME_Type *response);
+
+
+/**************************************************************************
+ * Function Name: showLinkStats
+ * Description  : Diagnostics, display the link counters of Control_ECU then
+ *                the ones of HMI_ECU, each page stays until a key is pressed
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showLinkStats(void);
+
+
+/**************************************************************************
+ * Function Name: showHmiStats
+ * Description  : Display the link counters of HMI_ECU
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showHmiStats(void);
+
+
+/**************************************************************************
+ * Function Name: displayLinkStats
+ * Description  : Display a page of the link counters, there are
+ *                APP_STATS_PAGES per ECU
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void displayLinkStats(void);
+
+
+/**************************************************************************
+ * Function Name: isPassMatched
+ * Description  : This function is to compare user entered password && system password
+ * INPUTS       : void
+ * RETURNS      : uint8
+ * 			      1 ==> Passwords match
+ * 			      0 ==> Passwords do not match
+ **************************************************************************/
+uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size);
 
 
 #endif /* APP_H_ */
@@ -0,0 +1,44 @@
+/*===========================================================================================
+ * Filename   : crc16.h
+ * Author     : Ahmad Haroun
+ * Description: Header file for the CRC-16 (CCITT) calculation
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* CRC-16/CCITT-FALSE : polynomial 0x1021, initial value 0xFFFF */
+#define CRC16_POLYNOMIAL     (0x1021U)
+#define CRC16_INITIAL_VALUE  (0xFFFFU)
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: CRC16_update
+ * Description  : Add one byte to a running CRC, used when the data comes
+ *                one byte at a time (start with CRC16_INITIAL_VALUE)
+ * INPUTS       : crc (the running CRC), data (the new byte)
+ * RETURNS      : uint16 (the updated CRC)
+ **************************************************************************/
+uint16 CRC16_update(uint16 crc, uint8 data);
+
+
+/**************************************************************************
+ * Function Name: CRC16_compute
+ * Description  : Calculate the CRC of a whole buffer
+ * INPUTS       : data (buffer), len (number of bytes)
+ * RETURNS      : uint16 (CRC of the buffer)
+ **************************************************************************/
+uint16 CRC16_compute(const uint8 *data, uint16 len);
+
+#endif /* CRC16_H_ */
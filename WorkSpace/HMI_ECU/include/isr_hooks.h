@@ -0,0 +1,42 @@
+/*===========================================================================================
+ * Filename   : isr_hooks.h
+ * Author     : Ahmad Haroun
+ * Description: Compile time table of the interrupt handlers of HMI_ECU
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#ifndef ISR_HOOKS_H_
+#define ISR_HOOKS_H_
+
+#include "tick.h"
+#include "gpio.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Each driver ISR expands its XXX_HOOK() right in its body, so the handler
+ * is a direct call or inlined, never a call through a pointer. A hook that
+ * is not defined here leaves an empty vector (only reti), that is the safe
+ * no-op default. Handlers run in ISR context with the interrupts disabled.
+ *
+ * TIMER1_OVF_HOOK      TIMER1_COMPA_HOOK    TIMER1_COMPB_HOOK    TIMER1_CAPT_HOOK
+ * UART_TX_COMPLETE_HOOK
+ * UART_RX_HOOK         (after the byte is in the RX ring buffer)
+ */
+
+/* Measurement aid: built with -DISR_HOOKS_PROBE (make EXTRA_CFLAGS=-DISR_HOOKS_PROBE)
+ * PD7, not used by this ECU, is high while the tick handler runs. The pulse
+ * width on a scope or a logic analyser is the handler time plus the 2 cycles
+ * of the sbi raising it, the vector jump and the ISR prologue/epilogue are
+ * outside of it (count them in the listing, avr-objdump -d).
+ * OPEN: the entry to handler cycles of the hooks, before and after they
+ * replaced the handler pointers, are not measured yet (no figures taken) */
+#ifdef ISR_HOOKS_PROBE
+#define TIMER1_COMPA_HOOK()    do { DDRD |= (1 << PD7); PORTD |= (1 << PD7); \
+                                    TICK_onCompare(); PORTD &= ~(1 << PD7); } while(0)
+#else
+#define TIMER1_COMPA_HOOK()    TICK_onCompare()
+#endif
+
+#endif /* ISR_HOOKS_H_ */
@@ -32,13 +32,23 @@
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/* returned by KEYPAD_scanKey when no button is pressed */
+#define KEYPAD_NO_KEY                     0xFF
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Scan the keypad once, without waiting
+ * Return the pressed button, or KEYPAD_NO_KEY
+ */
+uint8 KEYPAD_scanKey(void);
+
+/*
+ * Description :
+ * Wait for a button to be pressed and return it
  */
 uint8 KEYPAD_getPressedKey(void);
 
@@ -25,6 +25,7 @@
  * UART               : USE UART
  *==========================================================================================*/
 #include "app.h"
+#include "scheduler.h"
 
 
 /*******************************************************************************
@@ -34,8 +35,7 @@ int main()
 {
 	APP_init();        /* Initialize the Application */
 
-	while(1)
-	{
-		APP_start();   /* Run the Application */
-	}
+	APP_start();       /* Show the menu and scan the keypad */
+
+	SCHEDULER_run();   /* Event loop, sleeps while there is nothing to do */
 }
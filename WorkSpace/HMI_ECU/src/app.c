@@ -6,19 +6,80 @@
  *==========================================================================================*/
 #include "app.h"
 #include "lcd.h"
-#include <util/delay.h>
 #include "uart.h"
 #include "keypad.h"
-#include "timer1.h"
+#include "tick.h"
+#include "frame.h"
+#include "soft_timer.h"
+#include "scheduler.h"
 
 
+#if !TICK_IS_REACHABLE(APP_LOCKOUT_MS) || !TICK_IS_REACHABLE(APP_MESSAGE_MS) || \
+    !TICK_IS_REACHABLE(APP_KEYPAD_SCAN_MS) || !TICK_IS_REACHABLE(APP_DOOR_POLL_MS)
+#error "a delay of the application can not be reached with the tick"
+#endif
+
+/* the request timeouts are passed as uint16 */
+#if !TICK_IS_REACHABLE(APP_RESPONSE_TIMEOUT_MS) || !TICK_IS_REACHABLE(APP_PROBE_TIMEOUT_MS) || \
+    (APP_RESPONSE_TIMEOUT_MS > 0xFFFFUL) || (APP_PROBE_TIMEOUT_MS > 0xFFFFUL)
+#error "a request timeout can not be reached with the tick"
+#endif
+
 /*******************************************************************************
  *                      Global Variables                                       *
  *******************************************************************************/
 
-volatile uint8 ticks = 0;     /* used to indicate the required timer ticks to meet
- * the required delay time
+uint8 frame_seq = 0;          /* sequence number of the last request sent to Control_ECU */
+uint8 user_flags = 0;         /* FRAME_USER_xxx flags of the last user whose password was verified */
+
+/* the keypad timer scans the keypad, the door timer polls the door state of
+ * Control_ECU, the lockout timer ends the lockout while the display timer
+ * counts its seconds down on the LCD, or ends the message on the LCD
  */
+static SOFT_TIMER_Type keypad_timer;
+static SOFT_TIMER_Type door_timer;
+static SOFT_TIMER_Type lockout_timer;
+static SOFT_TIMER_Type display_timer;
+
+/* runs the action of a key press, posted by scanKeypad */
+static SCHEDULER_TaskType key_task = SCHEDULER_TASK(handleKey, SCHEDULER_PRIORITY_LOW);
+
+/* asks Control_ECU for the door state, posted by the door timer */
+static SCHEDULER_TaskType door_task = SCHEDULER_TASK(pollDoor, SCHEDULER_PRIORITY_LOW);
+
+static APP_ScreenType screen = SCREEN_MENU;
+static uint8 pressed_key = KEYPAD_NO_KEY;   /* key for handleKey */
+static boolean key_released = FALSE;        /* a key counts once, till it is released */
+static uint8 seconds_left = 0;
+static uint8 door_misses = 0;               /* door polls in a row Control_ECU did not answer */
+
+/* shown once the message on the LCD ends */
+static APP_ActionType message_next = showMenu;
+
+/* keys typed on an entry screen, a password, a PIN or a user ID */
+static uint8 entry[PASSWORD_MAX_LENGTH];
+static uint8 entry_size = 0;
+
+/* the first password typed by setPass, till it is confirmed */
+static uint8 new_pass[PASSWORD_MAX_LENGTH];
+static uint8 new_pass_size = 0;
+
+/* menu option waiting for the password, and the trials left for it */
+static uint8 pending_option = 0;
+static uint8 trials_left = 0;
+
+/* the last response of a paged screen (users, audit log), the next item
+ * to show from it and where the next request starts */
+static FRAME_Type page;
+static uint8 page_index = 0;
+static uint8 next_user_id = 0;
+static uint8 audit_cursor[2];
+static uint8 audit_cursor_length = 0;
+
+/* link statistics on the LCD, of Control_ECU or of HMI_ECU */
+static uint16 link_stats[FRAME_STATS_NUM];
+static boolean stats_of_control = FALSE;
+static uint8 stats_page = 0;
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -27,225 +88,581 @@ volatile uint8 ticks = 0;     /* used to indicate the required timer ticks to me
 /**************************************************************************
  * Function Name: APP_init
  * Description  : This function is responsible for initializing the peripherals
- *                (LCD && UART) and Setting the Password for 1st time
+ *                (LCD && UART) and finding Control_ECU on the link
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void APP_init(void)
 {
 	/* Crate a UART configuration Structure with the required properties */
-	UART_ConfigType config = {Character_8_bit, Parity_Disabled,Stop_One_bit,9600};
+	UART_ConfigType config = {Character_8_bit, Parity_Disabled,Stop_One_bit,UART_BAUD_9600};
 
 	/* Enable Global Interrupt */
 	SREG |= (1<<7);
 
+	/* shared 1 ms tick for all the delays and timeouts */
+	TICK_init();
+
 	/* initialize LCD, UART modules */
 	LCD_init();
 
 	UART_init(&config);
 
-	/* set password at startup */
-	setPass();
+	/* step up from 9600 to the fastest rate both ECUs support, nothing
+	 * can be done before Control_ECU answers (e.g. it boots later) */
+	while(APP_negotiateBaudRate(FRAME_SESSION_NEW) == FALSE){}
 }
 
 
 /**************************************************************************
  * Function Name: APP_start
- * Description  : This function is responsible for Running the system as required
+ * Description  : Show the main menu, or ask for the first password if
+ *                Control_ECU has none stored, and start scanning the
+ *                keypad, then SCHEDULER_run takes over
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void APP_start(void)
 {
-	boolean isCorrect;		/* used to check if entered password matches system password */
-	uint8 input = '\0'; 	/* used to get the user required action */
+	uint8 result = APP_request(FRAME_OP_GET_PROVISIONED, NULL_PTR, 0);
+
+	/* set password at startup, unless Control_ECU kept it over the reset,
+	 * or could not read its EEPROM at all */
+	if(FRAME_RESULT_STORAGE_ERROR == result)
+	{
+		showMessage("STORAGE ERROR", "", showMenu);
+	}
+	else if(FRAME_RESULT_SUCCESS != result)
+	{
+		setPass();
+	}
+	else
+	{
+		showMenu();
+	}
+
+	scanKeypad();
+}
 
 
-	/* Display main system options */
+/**************************************************************************
+ * Function Name: showMenu
+ * Description  : Display main system options, the keys now select one
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showMenu(void)
+{
+	screen = SCREEN_MENU;
+
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, " + : Open Door");
 	LCD_displayStringRowColumn(1, 0, " - : Change Pass");
+}
 
-	/* get user required action, keep prompting till a valid input is entered */
-	do
+/**************************************************************************
+ * Function Name: scanKeypad
+ * Description  : Callback of the keypad timer, post the key task when a
+ *                key is pressed (once per press)
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void scanKeypad(void)
+{
+	uint8 key = KEYPAD_scanKey();
+
+	if(key == KEYPAD_NO_KEY)
 	{
-		input = KEYPAD_getPressedKey();
-	}while(input != '+' && input != '-');
+		key_released = TRUE;
+	}
+	else if(key_released == TRUE)
+	{
+		key_released = FALSE;
+		pressed_key = key;
+		SCHEDULER_post(&key_task);
+	}
 
-	/* ask user for system password with 3 trials allowance */
-	isCorrect = checkPassword_trials();
-	if(isCorrect == FALSE)
+	/* one-shot, started again after each scan so the scans do not pile up
+	 * while a request waits for the response of Control_ECU */
+	SOFT_TIMER_start(&keypad_timer, APP_KEYPAD_SCAN_MS, 0, scanKeypad);
+}
+
+
+/**************************************************************************
+ * Function Name: handleKey
+ * Description  : Key task, act on the pressed key as the screen says. Every
+ *                screen takes one key and returns, so the timers and the
+ *                other tasks run between two keys
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void handleKey(void)
+{
+	uint8 key = pressed_key;
+
+	switch(screen)
 	{
-		/* all the 3 trials are used, lock the system */
-		lockSystem();
+	case SCREEN_MENU:
+		selectOption(key);
+		break;
+
+	case SCREEN_NEW_PASS:
+	case SCREEN_CONFIRM_PASS:
+		enterNewPass(key);
+		break;
+
+	case SCREEN_PASSWORD:
+		enterPassword(key);
+		break;
+
+	case SCREEN_ADMIN_MENU:
+		selectAdminOption(key);
+		break;
+
+	case SCREEN_NEW_USER_PIN:
+		enterNewUserPin(key);
+		break;
+
+	case SCREEN_NEW_USER_ROLE:
+		enterNewUserRole(key);
+		break;
+
+	case SCREEN_USER_ID:
+		enterUserId(key);
+		break;
+
+	case SCREEN_USERS:
+		/* any key, the next page of this response, else of the next one */
+		if((page_index + 1) < page.length)
+		{
+			showUsersPage();
+		}
+		else if(next_user_id != 0)
+		{
+			requestUsers();
+		}
+		else
+		{
+			showMenu();
+		}
+		break;
 
-		/* go to step 2 "main menu options"*/
-		return;
+	case SCREEN_AUDIT:
+		/* the ON key stops, any other key shows the next event */
+		if(APP_KEY_ENTER == key)
+		{
+			showMenu();
+		}
+		else if((page_index + FRAME_AUDIT_RECORD_SIZE) <= page.length)
+		{
+			showAuditRecord();
+		}
+		else
+		{
+			requestAudit();
+		}
+		break;
+
+	case SCREEN_STATS:
+		/* any key, the next page, the HMI_ECU counters after the Control_ECU ones */
+		stats_page++;
+		if(stats_page < APP_STATS_PAGES)
+		{
+			displayLinkStats();
+		}
+		else if(stats_of_control == TRUE)
+		{
+			showHmiStats();
+		}
+		else
+		{
+			showMenu();
+		}
+		break;
+
+	case SCREEN_DOOR:
+		/* any key stops the door, it closes back */
+		if(APP_request(FRAME_OP_ABORT_DOOR, NULL_PTR, 0) == FRAME_RESULT_SUCCESS)
+		{
+			pollDoor();
+		}
+		else
+		{
+			/* refused or not answered, the door state is not known any more */
+			SOFT_TIMER_stop(&door_timer);
+			showMessage("Door not stopped", "", showMenu);
+		}
+		break;
+
+	default:
+		/* a message or the lockout is on the LCD, no input received */
+		break;
 	}
+}
+
 
-	/* Execute the required action */
-	if('+' == input)
+/**************************************************************************
+ * Function Name: selectOption
+ * Description  : Run the main menu option of a key, the ones that need the
+ *                password ask for it first
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void selectOption(uint8 key)
+{
+	if('*' == key)
 	{
-		openDoor();
+		/* hidden diagnostics option, it does not need the password */
+		showLinkStats();
+	}
+	else if(('+' == key) || ('-' == key) || ('/' == key))
+	{
+		/* ask user for system password with 3 trials allowance */
+		pending_option = key;
+		trials_left = APP_PASSWORD_TRIALS;
+		askPassword();
 	}
 	else
 	{
-		/* change the password */
+		/* the menu stays till a valid input is entered */
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: runOption
+ * Description  : Run the menu option the password was asked for
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void runOption(void)
+{
+	if('+' == pending_option)
+	{
+		/* the door screen goes back to the menu itself */
+		openDoor();
+	}
+	else if('/' == pending_option)
+	{
+		/* hidden user administration option, only for an admin password */
+		if(user_flags & FRAME_USER_ADMIN)
+		{
+			adminMenu();
+		}
+		else
+		{
+			showMessage("ADMIN ONLY", "", showMenu);
+		}
+	}
+	else if(user_flags & FRAME_USER_ADMIN)
+	{
+		/* change the password, only for an admin password too */
 		setPass();
 	}
+	else
+	{
+		showMessage("ADMIN ONLY", "", showMenu);
+	}
 }
 
 
 /**************************************************************************
- * Function Name: setPassword
- * Description  : This function is responsible for setting and updating
- *                the password of the system
+ * Function Name: showMessage
+ * Description  : Show a message for APP_MESSAGE_MS, the keys are ignored
+ *                meanwhile, then the next screen is shown
+ * INPUTS       : row0 && row1 (text of the two rows), next (shows the next screen)
+ * RETURNS      : void
+ **************************************************************************/
+void showMessage(const char *row0, const char *row1, APP_ActionType next)
+{
+	screen = SCREEN_MESSAGE;
+	message_next = next;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, row0);
+	LCD_displayStringRowColumn(1, 0, row1);
+
+	SOFT_TIMER_start(&display_timer, APP_MESSAGE_MS, 0, endMessage);
+}
+
+
+/**************************************************************************
+ * Function Name: endMessage
+ * Description  : Callback of the display timer, the message ends
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void setPass(void)
+void endMessage(void)
 {
-	uint8 pass1[10] = ""; /* to store the first password */
-	uint8 pass2[10] = ""; /* to store the confirmation password */
-	uint8 pass1_size = 0; /* indicates pass1 length */
-	uint8 pass2_size = 0; /* indicates pass2 length */
+	message_next();
+}
 
-	boolean matched = FALSE;	  /* flag that is set when pass1 && pass2 are identical */
 
-	do
-	{
-		/* prompt user for password */
-		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 0, "Plz enter pass: ");
-		LCD_moveCursor(1, 0);
+/**************************************************************************
+ * Function Name: startEntry
+ * Description  : Show a prompt and wait for the keys of an entry, each key
+ *                is taken by the entry screen till the ON key ends it
+ * INPUTS       : title (row 0), prompt (row 1, the keys follow it),
+ *                entry_screen (screen that takes the keys)
+ * RETURNS      : void
+ **************************************************************************/
+void startEntry(const char *title, const char *prompt, APP_ScreenType entry_screen)
+{
+	screen = entry_screen;
+	entry_size = 0;
 
-		/* get the password for the first time */
-		getPass(pass1, &pass1_size);
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, title);
+	LCD_displayStringRowColumn(1, 0, prompt);
+}
 
-		/* prompt user to confirm the password */
-		LCD_displayStringRowColumn(0, 0, "Plz re-enter the");
-		LCD_displayStringRowColumn(1, 0, "same pass: ");
 
-		/* get the password for the second time */
-		getPass(pass2, &pass2_size);
+/**************************************************************************
+ * Function Name: enterKey
+ * Description  : Add a key to the entry, a secret key is shown as '*' and
+ *                any key is taken, else only the digits are taken and shown.
+ *                The keys after PASSWORD_MAX_LENGTH are ignored
+ * INPUTS       : key, secret
+ * RETURNS      : boolean (TRUE once the ON key ends the entry)
+ **************************************************************************/
+boolean enterKey(uint8 key, boolean secret)
+{
+	if(APP_KEY_ENTER == key)
+	{
+		return TRUE;
+	}
 
-		/* Check if the two passwords match*/
-		if(pass1_size != pass2_size)
+	if((entry_size < PASSWORD_MAX_LENGTH) && ((secret == TRUE) || (key <= 9)))
+	{
+		entry[entry_size++] = key;
+		if(secret == TRUE)
 		{
-			/* if the two passwords are of different sizes, they are already mismatched */
-			LCD_clearScreen();
-			LCD_displayStringRowColumn(0, 0, "Error!! ");
-			LCD_displayStringRowColumn(1, 0, "NOT MATCHED");
-			_delay_ms(1000);
-			continue;
+			LCD_displayCharacter('*');		/* print '*' on LCD in place of the entered keypad value */
 		}
 		else
 		{
-			/* if the 2 passwords are the same size, check if they match */
-			matched = isPassMatched(pass1, pass2, pass1_size);
-
-			LCD_clearScreen();
-
-			if(matched == TRUE)
-			{
-				/* if matched, send the password to the Control_ECU to be stored in EEPROM */
-				LCD_displayStringRowColumn(0, 0, "Pass set");
-				LCD_displayStringRowColumn(1, 0, "Successfully");
-
-				UART_sendByte('0');
-				UART_sendString(pass1);
-
-			}
-			else
-			{
-				/* if not matched, print error messages and prompt from the beginning */
-				LCD_displayStringRowColumn(0, 0, "Error!! ");
-				LCD_displayStringRowColumn(1, 0, "NOT MATCHED");
-			}
-			TIMER1_delay_1sec();
+			LCD_intgerToString(key);
 		}
-	}while(matched == FALSE); /* keep prompting for a correct password to be set */
+	}
+
+	return FALSE;
 }
 
 
 /**************************************************************************
- * Function Name: checkPassword_trials
- * Description  : This function is responsible for prompting the user for correct passwords,
- * 		          within maximum 3 times.
+ * Function Name: setPass
+ * Description  : This function is responsible for setting and updating
+ *                the password of the system, it asks for the new password
  * INPUTS       : void
- * RETURNS      : uint8
- *                1 Password is correct.
- * 		   	      0 All trials are used without password being correct
+ * RETURNS      : void
  **************************************************************************/
-uint8 checkPassword_trials(void)
+void setPass(void)
 {
-	uint8 maxTrials;
-	uint8 isCorrect;
+	startEntry("Plz enter pass: ", "", SCREEN_NEW_PASS);
+}
 
-	for(maxTrials = 3; maxTrials > 0; maxTrials--)
+
+/**************************************************************************
+ * Function Name: enterNewPass
+ * Description  : Key of the new password, or of its confirmation. The
+ *                password is sent to Control_ECU once both match, else
+ *                it is asked from the beginning
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterNewPass(uint8 key)
+{
+	uint8 i;
+
+	if(enterKey(key, TRUE) == FALSE)
 	{
-		/* prompt user to enter the system password to execute the required action,
-		 * then check if password is correct
-		 */
-		isCorrect = verifyPass_ControlECU();
+		return;
+	}
 
-		if ('1' == isCorrect)
-		{
-			/* password is correct */
-			LCD_clearScreen();
-			LCD_displayStringRowColumn(0, 0, "ACCESS GRANTED");
-			TIMER1_delay_1sec();
-			return 1;
-		}
-		else
+	if(SCREEN_NEW_PASS == screen)
+	{
+		/* prompt user to confirm the password */
+		for(i = 0; i < entry_size; i++)
 		{
-			/* if password is false */
-			LCD_clearScreen();
-			LCD_displayStringRowColumn(0, 0, "ACCESS DENIED");
-			TIMER1_delay_1sec();
+			new_pass[i] = entry[i];
 		}
+		new_pass_size = entry_size;
+		startEntry("Plz re-enter the", "same pass: ", SCREEN_CONFIRM_PASS);
+	}
+	else if((entry_size != new_pass_size) || (isPassMatched(new_pass, entry, entry_size) == FALSE))
+	{
+		/* if not matched, print error messages and prompt from the beginning */
+		showMessage("Error!! ", "NOT MATCHED", setPass);
+	}
+	else if(APP_request(FRAME_OP_SET_PASSWORD, entry, entry_size) == FRAME_RESULT_SUCCESS)
+	{
+		/* Control_ECU stored the password in the EEPROM */
+		showMessage("Pass set", "Successfully", showMenu);
+	}
+	else
+	{
+		/* Control_ECU refused it or did not answer, prompt from the beginning */
+		showMessage("Error!! ", "NOT SAVED", setPass);
 	}
-	/* all 3 trials are used without password being correct */
-	return 0;
 }
 
 
+/**************************************************************************
+ * Function Name: askPassword
+ * Description  : Prompt the user for the system password
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void askPassword(void)
+{
+	startEntry("Plz enter pass:", "", SCREEN_PASSWORD);
+}
+
+
+/**************************************************************************
+ * Function Name: enterPassword
+ * Description  : Key of the system password, once entered it is checked
+ *                by Control_ECU (and the user table). A correct one runs
+ *                the pending option, a wrong one uses a trial and the
+ *                system is locked after APP_PASSWORD_TRIALS. A timeout or
+ *                a storage error is not a trial, it goes back to the menu
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterPassword(uint8 key)
+{
+	FRAME_Type response;
+	uint8 result;
+
+	if(enterKey(key, TRUE) == FALSE)
+	{
+		return;
+	}
+
+	/* keep the flags of the matching user */
+	result = APP_requestData(FRAME_OP_VERIFY_PASSWORD, entry, entry_size, &response);
+	user_flags = ((result == FRAME_RESULT_SUCCESS) && (response.length == 3)) ? response.payload[2] : 0;
+
+	if(FRAME_RESULT_TIMEOUT == result)
+	{
+		/* Control_ECU did not answer */
+		showMessage("NO RESPONSE", "", showMenu);
+	}
+	else if(FRAME_RESULT_STORAGE_ERROR == result)
+	{
+		/* Control_ECU could not read its EEPROM */
+		showMessage("STORAGE ERROR", "", showMenu);
+	}
+	else if(FRAME_RESULT_SUCCESS == result)
+	{
+		showMessage("ACCESS GRANTED", "", runOption);
+	}
+	else
+	{
+		/* all the trials are used, lock the system */
+		trials_left--;
+		showMessage("ACCESS DENIED", "", (trials_left == 0) ? lockSystem : askPassword);
+	}
+}
+
 
 /**************************************************************************
  * Function Name: openDoor
- * Description  : This function is responsible for executing the steps required to open the door
+ * Description  : This function is responsible for executing the steps required to open the door,
+ *                Control_ECU runs the door cycle, the door timer polls its
+ *                state and any key aborts it, back to the menu if it is refused
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
 void openDoor(void)
 {
-	int count_down = 3;
 	/* Send a command to control_ECU to open the door */
-	UART_sendByte('2');
-	/* display opening message for 15 seconds */
-	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is Unlocking");
-	TIMER1_delay_15sec();
+	if(APP_request(FRAME_OP_OPEN_GATE, NULL_PTR, 0) != FRAME_RESULT_SUCCESS)
+	{
+		showMessage("Door not opened", "", showMenu);
+		return;
+	}
 
-	/* display time remaining to lock the door */
+	door_misses = 0;
+	screen = SCREEN_DOOR;
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door locks in");
-	LCD_displayStringRowColumn(1, 8, "3");
+	pollDoor();
+}
+
+
+/**************************************************************************
+ * Function Name: postDoorPoll
+ * Description  : Callback of the door timer, post the door task, the
+ *                request is not sent from inside SOFT_TIMER_process
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void postDoorPoll(void)
+{
+	SCHEDULER_post(&door_task);
+}
+
 
-	while(count_down--)
+/**************************************************************************
+ * Function Name: pollDoor
+ * Description  : Door task, show the stage of the door
+ *                cycle and the seconds left, back to the menu once it is closed
+ *                or after APP_DOOR_POLL_TRIES polls without an answer
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void pollDoor(void)
+{
+	FRAME_Type response;
+
+	/* a poll posted before the door screen was left */
+	if(screen != SCREEN_DOOR)
 	{
-		/* update count_down variable every 1 second */
-		TIMER1_delay_1sec();
-		LCD_moveCursor(1, 8);
-		LCD_intgerToString(count_down);
+		return;
 	}
 
-	/* display locking the door warning */
-	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is locking  ");
-	TIMER1_delay_15sec();
-}
+	if((APP_requestData(FRAME_OP_GET_DOOR_STATE, NULL_PTR, 0, &response) == FRAME_RESULT_SUCCESS) &&
+	   (response.length >= 3))
+	{
+		door_misses = 0;
 
+		switch(response.payload[1])
+		{
+		case FRAME_DOOR_OPENING:	/* display opening message */
+			LCD_displayStringRowColumn(0, 0, "Door is Unlocking");
+			break;
+
+		case FRAME_DOOR_HOLDING:	/* display time remaining to lock the door */
+			LCD_displayStringRowColumn(0, 0, "Door locks in   ");
+			break;
+
+		case FRAME_DOOR_CLOSING:	/* display locking the door warning */
+			LCD_displayStringRowColumn(0, 0, "Door is locking ");
+			break;
+
+		default:	/* the door is closed */
+			SOFT_TIMER_stop(&door_timer);
+			showMenu();
+			return;
+		}
+		showSeconds(response.payload[2]);
+	}
+	else if(++door_misses < APP_DOOR_POLL_TRIES)
+	{
+		/* Control_ECU did not answer, try again at the next poll */
+		LCD_displayStringRowColumn(0, 0, "NO RESPONSE     ");
+	}
+	else
+	{
+		/* Control_ECU is gone, do not keep the user on the door screen */
+		SOFT_TIMER_stop(&door_timer);
+		showMessage("NO RESPONSE", "", showMenu);
+		return;
+	}
+
+	/* one-shot, a poll that waits for a response does not make the next one early */
+	SOFT_TIMER_start(&door_timer, APP_DOOR_POLL_MS, 0, postDoorPoll);
+}
 
 
 /**************************************************************************
@@ -257,172 +674,637 @@ void openDoor(void)
  **************************************************************************/
 void lockSystem(void)
 {
-	uint8 timer_counter ; /* used to repeat the 15sec delay function to get 1 min*/
 	/* activate buzzer for 1 minute "send relative signal to control_mcu" */
-	UART_sendByte('3');
+	APP_request(FRAME_OP_LOCK_SYSTEM, NULL_PTR, 0);
 
-	/* display error message on lcd for 1 minute */
+	/* display error message on lcd for 1 minute, with the seconds left,
+	 * the keys are ignored meanwhile */
+	screen = SCREEN_LOCKED;
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "MAX TRIALS USED");
-	LCD_displayStringRowColumn(1, 0, "SYSTEM IS LOCKED");
-	/* no input received */
+	LCD_displayStringRowColumn(0, 0, "SYSTEM IS LOCKED");
+
+	SOFT_TIMER_start(&lockout_timer, APP_LOCKOUT_MS, 0, endLockout);
+	startCountdown((uint8)(APP_LOCKOUT_MS / 1000));
+}
+
+
+/**************************************************************************
+ * Function Name: endLockout
+ * Description  : Callback of the lockout timer, back to the menu
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void endLockout(void)
+{
+	SOFT_TIMER_stop(&display_timer);
+	showMenu();
+}
+
+
+/**************************************************************************
+ * Function Name: startCountdown
+ * Description  : Show a number of seconds on row 1 and start the display
+ *                timer that counts it down every second
+ * INPUTS       : seconds
+ * RETURNS      : void
+ **************************************************************************/
+void startCountdown(uint8 seconds)
+{
+	seconds_left = seconds;
+	showSeconds(seconds_left);
+	SOFT_TIMER_start(&display_timer, 1000, 1000, countDown);
+}
+
 
-	/* Delay 1 minute */
-	for(timer_counter = 0; timer_counter < 4; timer_counter++)
+/**************************************************************************
+ * Function Name: countDown
+ * Description  : Callback of the display timer, show one second less
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void countDown(void)
+{
+	if(seconds_left != 0)
 	{
-		TIMER1_delay_15sec();
+		seconds_left--;
 	}
+
+	showSeconds(seconds_left);
 }
 
 
+/**************************************************************************
+ * Function Name: showSeconds
+ * Description  : Show a number of seconds left on row 1
+ * INPUTS       : seconds
+ * RETURNS      : void
+ **************************************************************************/
+void showSeconds(uint8 seconds)
+{
+	LCD_displayStringRowColumn(1, 0, "Seconds left");
+
+	/* the blank clears the second digit once it gets below 10 */
+	LCD_moveCursor(1, APP_COUNTDOWN_COLUMN);
+	LCD_intgerToString(seconds);
+	LCD_displayCharacter(' ');
+}
+
 
 /**************************************************************************
- * Function Name: verifyPass_ControlECU
- * Description  : This function is to compare password entered by user to
- *                the saved password of the system
+ * Function Name: adminMenu
+ * Description  : User administration, add a user, revoke a user, list
+ *                the users stored in Control_ECU or read its audit log
  * INPUTS       : void
- * RETURNS      : uint8
- *                '1' Password is correct.
- * 		   	      '0' Password is false.
+ * RETURNS      : void
  **************************************************************************/
-uint8 verifyPass_ControlECU(void)
+void adminMenu(void)
 {
-	uint8 response = 0;		/* flag that is set if entered password matches the system password */
-	uint8 pass[10] = "";	/* to store the user entered password */
-	uint8 pass_size = 0;	/* to indicate the user entered password size */
+	screen = SCREEN_ADMIN_MENU;
 
-	/* prompt for password */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Plz enter pass:");
-	LCD_moveCursor(1, 0);
+	LCD_displayStringRowColumn(0, 0, "1:Add 2:Revoke");
+	LCD_displayStringRowColumn(1, 0, "3:List 4:Log");
+}
 
-	/* get user entered password */
-	getPass(pass, &pass_size);
 
-	/* send the password to the Control_ECU to be check with system password */
-	UART_sendByte('1');
-	_delay_ms(10);
-	UART_sendString(pass);
+/**************************************************************************
+ * Function Name: selectAdminOption
+ * Description  : Run the administration option of a key
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void selectAdminOption(uint8 key)
+{
+	if(1 == key)
+	{
+		addUser();
+	}
+	else if(2 == key)
+	{
+		revokeUser();
+	}
+	else if(3 == key)
+	{
+		listUsers();
+	}
+	else if(4 == key)
+	{
+		showAudit();
+	}
+	else
+	{
+		/* the menu stays till a valid input is entered */
+	}
+}
+
 
-	/* receive Control_ECU response */
-	response = UART_recieveByte();
-	return response;
+/**************************************************************************
+ * Function Name: addUser
+ * Description  : Ask for the PIN of a new user
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void addUser(void)
+{
+	startEntry("New user PIN:", "", SCREEN_NEW_USER_PIN);
 }
 
 
+/**************************************************************************
+ * Function Name: enterNewUserPin
+ * Description  : Key of the PIN of a new user, then ask for its role
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterNewUserPin(uint8 key)
+{
+	if(enterKey(key, TRUE) == FALSE)
+	{
+		return;
+	}
+
+	screen = SCREEN_NEW_USER_ROLE;
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "1:User 2:Admin");
+}
+
 
 /**************************************************************************
- * Function Name: getPass
- * Description  : This function is responsible for storing the user entered password,
- * 		          and printing '*' on LCD instead of each entered character
- * INPUTS       : password array && Size of password passed by address
+ * Function Name: enterNewUserRole
+ * Description  : Key of the role of a new user, then store it in
+ *                Control_ECU, the new user ID is displayed
+ * INPUTS       : key
  * RETURNS      : void
  **************************************************************************/
-void getPass(uint8 *passArr, uint8 *size)
+void enterNewUserRole(uint8 key)
 {
-	_delay_ms(100);
+	FRAME_Type response;
+	uint8 request[1 + PASSWORD_MAX_LENGTH];	/* user flags + PIN */
+	uint8 i;
 
-	*size = 0;
-	do
+	if((key != 1) && (key != 2))
 	{
-		passArr[*size] = KEYPAD_getPressedKey();	/* store the entered keypad character in the array,increment its size */
-		(*size)++;
-		if(passArr[(*size) - 1] != 13)
-		{
-			LCD_displayCharacter('*');		/* print '*' on LCD in place of the entered keypad value, ignore ON key press */
-		}
-		_delay_ms(250);				       /* wait 250 between two keypad presses */
-	}while(passArr[(*size) - 1] != 13);   /* keep storing characters till ON key is pressed */
-	passArr[--(*size)] = '\0'; /* terminate input string by null character, remove the enter character */
+		return;
+	}
 
+	request[0] = (2 == key) ? FRAME_USER_ADMIN : 0;
+	for(i = 0; i < entry_size; i++)
+	{
+		request[1 + i] = entry[i];
+	}
+
+	if((APP_requestData(FRAME_OP_ADD_USER, request, 1 + entry_size, &response) == FRAME_RESULT_SUCCESS) &&
+	   (response.length == 2))
+	{
+		showMessage("User added", "ID: ", showMenu);
+		LCD_intgerToString(response.payload[1]);
+	}
+	else
+	{
+		/* table full, PIN already used, storage error or no response */
+		showMessage("Error!! ", "NOT ADDED", showMenu);
+	}
 }
 
 
 /**************************************************************************
- * Function Name: isPassMatched
- * Description  : This function is to compare user entered password && system password
+ * Function Name: revokeUser
+ * Description  : Ask for the ID of the user to remove
  * INPUTS       : void
- * RETURNS      : uint8
- * 			      1 ==> Passwords match
- * 			      0 ==> Passwords do not match
+ * RETURNS      : void
  **************************************************************************/
-uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size)
+void revokeUser(void)
+{
+	startEntry("User ID:", "", SCREEN_USER_ID);
+}
+
+
+/**************************************************************************
+ * Function Name: enterUserId
+ * Description  : Digit of a user ID, the ON key ends it and that user is
+ *                removed from Control_ECU
+ * INPUTS       : key
+ * RETURNS      : void
+ **************************************************************************/
+void enterUserId(uint8 key)
 {
+	uint8 user_id = 0;	/* it wraps above 255 */
 	uint8 i;
-	boolean matched = TRUE;
-	for(i = 0 ; i < size; ++i)
+
+	if(enterKey(key, FALSE) == FALSE)
 	{
-		if(pass1[i] != pass2[i])
+		return;
+	}
+
+	for(i = 0; i < entry_size; i++)
+	{
+		user_id = (user_id * 10) + entry[i];
+	}
+
+	if(APP_request(FRAME_OP_REVOKE_USER, &user_id, 1) == FRAME_RESULT_SUCCESS)
+	{
+		showMessage("User revoked", "", showMenu);
+	}
+	else
+	{
+		showMessage("Error!! ", "NOT REVOKED", showMenu);
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: listUsers
+ * Description  : Display the IDs of the stored users, a page per response
+ *                of Control_ECU, admins are marked with 'A'. Each page stays
+ *                until a key is pressed
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void listUsers(void)
+{
+	next_user_id = 1;
+	requestUsers();
+}
+
+
+/**************************************************************************
+ * Function Name: requestUsers
+ * Description  : Get the next response of the user list and show its first page
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void requestUsers(void)
+{
+	if(APP_requestData(FRAME_OP_LIST_USERS, &next_user_id, 1, &page) != FRAME_RESULT_SUCCESS)
+	{
+		showMessage("NO RESPONSE", "", showMenu);
+		return;
+	}
+
+	/* (ID, flags) pairs after the result and the next first ID */
+	next_user_id = page.payload[1];
+	page_index = 2;
+	showUsersPage();
+}
+
+
+/**************************************************************************
+ * Function Name: showUsersPage
+ * Description  : Show the next users of the response, 4 per LCD row
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showUsersPage(void)
+{
+	uint8 shown = 0;
+
+	screen = SCREEN_USERS;
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "Users:");
+
+	while((shown < 4) && ((page_index + 1) < page.length))
+	{
+		LCD_moveCursor(1, shown * 4);
+		LCD_intgerToString(page.payload[page_index]);
+		if(page.payload[page_index + 1] & FRAME_USER_ADMIN)
 		{
-			matched = FALSE;
-			break;
+			LCD_displayCharacter('A');
 		}
-
+		page_index += 2;
+		shown++;
 	}
-	return matched;
 }
 
 
 /**************************************************************************
- * Function Name: TIMER1_delay_15sec
- * Description  : This function is to generate 15 seconds delay using timer1.
+ * Function Name: showAudit
+ * Description  : Read the audit log of Control_ECU from the oldest event,
+ *                one event per page, a key shows the next one and the ON
+ *                key stops
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_15sec(void)
+void showAudit(void)
 {
-	/* (7.5 SEC) == 58594 */
-	Timer1_ConfigType config = {0,58594,TIMER1_PRESCALER_1024,Timer1_CTC_Mode};
-	Timer1_init(&config);
-	TIMER1_Set_CallBack(TIMER1_callback_function,1);
-	while(ticks < 2);
-	ticks = 0;
-	Timer1_deInit();
+	/* no SEQ in the first request, the dump starts at the oldest event */
+	audit_cursor_length = 0;
+	requestAudit();
 }
 
 
+/**************************************************************************
+ * Function Name: requestAudit
+ * Description  : Get the next events of the audit log and show the first one
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void requestAudit(void)
+{
+	if(APP_requestData(FRAME_OP_READ_AUDIT, audit_cursor, audit_cursor_length, &page) != FRAME_RESULT_SUCCESS)
+	{
+		showMessage("NO RESPONSE", "", showMenu);
+		return;
+	}
+	audit_cursor[0] = page.payload[1];
+	audit_cursor[1] = page.payload[2];
+	audit_cursor_length = 2;
+
+	page_index = 3;
+	if((page_index + FRAME_AUDIT_RECORD_SIZE) > page.length)
+	{
+		/* the last response carries no record */
+		showMessage("END OF LOG", "", showMenu);
+		return;
+	}
+
+	showAuditRecord();
+}
+
 
 /**************************************************************************
- * Function Name: TIMER1_delay_3sec
- * Description  : This function is to generate 1 seconds delay using timer1.
+ * Function Name: showAuditRecord
+ * Description  : Show the next event of the response
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_delay_1sec(void)
+void showAuditRecord(void)
+{
+	const uint8 *record = &page.payload[page_index];
+	uint32 time = record[2] | ((uint32)record[3] << 8) | ((uint32)record[4] << 16);
+
+	screen = SCREEN_AUDIT;
+	page_index += FRAME_AUDIT_RECORD_SIZE;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, getEventName(record[5]));
+
+	/* user, time since that reset as hours:minutes, then the result */
+	LCD_displayStringRowColumn(1, 0, "U:");
+	if(record[6] == 0xFF)
+	{
+		LCD_displayCharacter('-');
+	}
+	else
+	{
+		LCD_intgerToString(record[6]);
+	}
+	LCD_displayCharacter(' ');
+	LCD_intgerToString((int)(time / 3600));
+	LCD_displayCharacter(':');
+	if(((time / 60) % 60) < 10)
+	{
+		LCD_displayCharacter('0');
+	}
+	LCD_intgerToString((int)((time / 60) % 60));
+	LCD_displayString((record[7] == FRAME_RESULT_SUCCESS) ? " OK" : " ERR");
+}
+
+
+/**************************************************************************
+ * Function Name: getEventName
+ * Description  : Text of an audit event, at most 16 characters
+ * INPUTS       : event (FRAME_EVENT_xxx)
+ * RETURNS      : const char*
+ **************************************************************************/
+const char* getEventName(uint8 event)
 {
-	/* required OCR value to generate 1 second at 1024 pre-scaler is 7813*/
-	/* Timer will run in CTC, so we can put any number in TCNT1 for the config*/
-	Timer1_ConfigType config = {0,7813,TIMER1_PRESCALER_1024, Timer1_CTC_Mode};
-	Timer1_init(&config);
+	switch(event)
+	{
+	case FRAME_EVENT_BOOT:           return "BOOT";
+	case FRAME_EVENT_ACCESS_GRANTED: return "ACCESS GRANTED";
+	case FRAME_EVENT_ACCESS_DENIED:  return "ACCESS DENIED";
+	case FRAME_EVENT_LOCKOUT:        return "LOCKOUT";
+	case FRAME_EVENT_DOOR_OPENED:    return "DOOR OPENED";
+	case FRAME_EVENT_PASSWORD_SET:   return "PASSWORD SET";
+	case FRAME_EVENT_USER_ADDED:     return "USER ADDED";
+	case FRAME_EVENT_USER_REVOKED:   return "USER REVOKED";
+	default:                         return "UNKNOWN EVENT";
+	}
+}
 
-	/* set timer callback function */
-	TIMER1_Set_CallBack(TIMER1_callback_function,1);
-	/* wait for timer to generate the interrupt */
-	while(ticks == 0)
+
+/**************************************************************************
+ * Function Name: APP_negotiateBaudRate
+ * Description  : Link speed handshake, find the rate Control_ECU is listening at,
+ *                send it the supported profiles then switch to the profile it answers with.
+ *                One pass over the profiles, it gives up after at most
+ *                UART_BAUD_PROFILES_NUM * APP_PROBE_TIMEOUT_MS
+ * INPUTS       : session (FRAME_SESSION_NEW after a reset of HMI_ECU,
+ *                FRAME_SESSION_RESUMED after a timeout)
+ * RETURNS      : boolean (FALSE if Control_ECU answered at no rate)
+ **************************************************************************/
+boolean APP_negotiateBaudRate(uint8 session)
+{
+	FRAME_Type request;
+	FRAME_Type response;
+	sint8 baud_rate;
+
+	request.opcode = FRAME_OP_SET_BAUD_RATE;
+	request.length = 2;
+	request.payload[0] = UART_getSupportedBaudRates();
+	request.payload[1] = session;
+
+	/* Control_ECU may be at any rate (e.g. only HMI_ECU was reset),
+	 * so probe from the fastest profile down to 9600, the link is left
+	 * at 9600 when it never answers
+	 */
+	for(baud_rate = UART_BAUD_PROFILES_NUM - 1; baud_rate >= UART_BAUD_9600; baud_rate--)
 	{
+		if(UART_setBaudRate((UART_BaudRate)baud_rate) == FALSE)
+		{
+			continue;
+		}
 
-	};
+		request.seq = ++frame_seq;
+		if((FRAME_transact(&request, &response, APP_PROBE_TIMEOUT_MS, 0) == FRAME_COMPLETE) &&
+		   (response.length == 2) && (response.payload[0] == FRAME_RESULT_SUCCESS))
+		{
+			/* Control_ECU already switched right after sending the response */
+			UART_setBaudRate((UART_BaudRate)response.payload[1]);
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
 
-	/* reset ticks variable for the next future use */
-	ticks = 0;
 
-	/* reset timer1 configurations */
-	Timer1_deInit();
+/**************************************************************************
+ * Function Name: APP_request
+ * Description  : Send a request frame to Control_ECU and wait for its response
+ * INPUTS       : opcode (FRAME_OP_xxx), payload && length of the payload
+ * RETURNS      : uint8 (result byte of the response FRAME_RESULT_xxx,
+ *                FRAME_RESULT_TIMEOUT if Control_ECU never answered)
+ **************************************************************************/
+uint8 APP_request(uint8 opcode, const uint8 *payload, uint8 length)
+{
+	FRAME_Type response;
 
+	return APP_requestData(opcode, payload, length, &response);
 }
 
 
 /**************************************************************************
- * Function Name: TIMER1_callback_function
- * Description  : The required function to be executed when timer interrupt
- *                is fired, "increments ticks variable"
+ * Function Name: APP_requestData
+ * Description  : Same as APP_request but the whole response is returned too,
+ *                for requests whose response carries data after the result
+ * INPUTS       : opcode (FRAME_OP_xxx), payload && length of the payload,
+ *                response (where the response frame is saved)
+ * RETURNS      : uint8 (result byte of the response FRAME_RESULT_xxx,
+ *                FRAME_RESULT_TIMEOUT if Control_ECU never answered)
+ **************************************************************************/
+uint8 APP_requestData(uint8 opcode, const uint8 *payload, uint8 length, FRAME_Type *response)
+{
+	FRAME_Type request;
+	FRAME_StatusType status;
+	uint8 i;
+
+	request.opcode = opcode;
+	request.seq = ++frame_seq;
+	request.length = length;
+	for(i = 0; i < length; i++)
+	{
+		request.payload[i] = payload[i];
+	}
+
+	status = FRAME_transact(&request, response, APP_RESPONSE_TIMEOUT_MS, APP_REQUEST_RETRIES);
+	if((status == FRAME_TIMEOUT) && (APP_negotiateBaudRate(FRAME_SESSION_RESUMED) == TRUE))
+	{
+		/* Control_ECU had been reset back to 9600, it is found again, retry once.
+		 * Same SEQ: if only the responses were lost Control_ECU answers from its
+		 * last response, the request is not executed twice */
+		status = FRAME_transact(&request, response, APP_RESPONSE_TIMEOUT_MS, 0);
+	}
+
+	if(status == FRAME_TIMEOUT)
+	{
+		return FRAME_RESULT_TIMEOUT;
+	}
+
+	return (response->length != 0) ? response->payload[0] : FRAME_RESULT_FAIL;
+}
+
+
+/**************************************************************************
+ * Function Name: showLinkStats
+ * Description  : Diagnostics, display the link counters of Control_ECU then
+ *                the ones of HMI_ECU, each page stays until a key is pressed
  * INPUTS       : void
  * RETURNS      : void
  **************************************************************************/
-void TIMER1_callback_function(void)
+void showLinkStats(void)
 {
-	ticks++;
+	FRAME_Type response;
+	uint8 i;
+
+	if((APP_requestData(FRAME_OP_GET_STATS, NULL_PTR, 0, &response) == FRAME_RESULT_SUCCESS) &&
+	   (response.length == (1 + (FRAME_STATS_NUM * 2))))
+	{
+		for(i = 0; i < FRAME_STATS_NUM; i++)
+		{
+			link_stats[i] = response.payload[1 + (2 * i)] | ((uint16)response.payload[2 + (2 * i)] << 8);
+		}
+		stats_of_control = TRUE;
+		stats_page = 0;
+		displayLinkStats();
+	}
+	else
+	{
+		showMessage("NO RESPONSE", "", showHmiStats);
+	}
 }
 
 
+/**************************************************************************
+ * Function Name: showHmiStats
+ * Description  : Display the link counters of HMI_ECU
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void showHmiStats(void)
+{
+	FRAME_getStats(link_stats);
+	stats_of_control = FALSE;
+	stats_page = 0;
+	displayLinkStats();
+}
 
+
+/**************************************************************************
+ * Function Name: displayLinkStats
+ * Description  : Display a page of the link counters, there are
+ *                APP_STATS_PAGES per ECU
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void displayLinkStats(void)
+{
+	screen = SCREEN_STATS;
+	LCD_clearScreen();
+
+	switch(stats_page)
+	{
+	case 0:
+		LCD_displayStringRowColumn(0, 0, (stats_of_control == TRUE) ? "CONTROL LINK" : "HMI LINK");
+		LCD_displayStringRowColumn(1, 0, "TX:");
+		LCD_intgerToString(link_stats[FRAME_STAT_FRAMES_SENT]);
+		LCD_displayString(" RX:");
+		LCD_intgerToString(link_stats[FRAME_STAT_FRAMES_RECEIVED]);
+		break;
+
+	case 1:
+		LCD_displayStringRowColumn(0, 0, "CRC:");
+		LCD_intgerToString(link_stats[FRAME_STAT_CRC_ERRORS]);
+		LCD_displayString(" TO:");
+		LCD_intgerToString(link_stats[FRAME_STAT_TIMEOUTS]);
+		LCD_displayStringRowColumn(1, 0, "RTY:");
+		LCD_intgerToString(link_stats[FRAME_STAT_RETRIES]);
+		LCD_displayString(" OVR:");
+		LCD_intgerToString(link_stats[FRAME_STAT_OVERRUN_ERRORS]);
+		break;
+
+	case 2:
+		LCD_displayStringRowColumn(0, 0, "FE:");
+		LCD_intgerToString(link_stats[FRAME_STAT_FRAMING_ERRORS]);
+		LCD_displayString(" PE:");
+		LCD_intgerToString(link_stats[FRAME_STAT_PARITY_ERRORS]);
+		LCD_displayStringRowColumn(1, 0, "DROP:");
+		LCD_intgerToString(link_stats[FRAME_STAT_BUFFER_OVERRUNS]);
+		break;
+
+	default:
+		/* last request this ECU sent, in ms with one decimal */
+		LCD_displayStringRowColumn(0, 0, "ROUND TRIP:");
+		LCD_moveCursor(1, 0);
+		LCD_intgerToString(link_stats[FRAME_STAT_ROUND_TRIP] / 10);
+		LCD_displayString(".");
+		LCD_intgerToString(link_stats[FRAME_STAT_ROUND_TRIP] % 10);
+		LCD_displayString(" ms");
+		break;
+	}
+}
+
+
+/**************************************************************************
+ * Function Name: isPassMatched
+ * Description  : This function is to compare user entered password && system password
+ * INPUTS       : void
+ * RETURNS      : uint8
+ * 			      1 ==> Passwords match
+ * 			      0 ==> Passwords do not match
+ **************************************************************************/
+uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size)
+{
+	uint8 i;
+	boolean matched = TRUE;
+	for(i = 0 ; i < size; ++i)
+	{
+		if(pass1[i] != pass2[i])
+		{
+			matched = FALSE;
+			break;
+		}
+
+	}
+	return matched;
+}
@@ -0,0 +1,58 @@
+/*===========================================================================================
+ * Filename   : clock.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the monotonic millisecond/microsecond clock
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "clock.h"
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* microseconds of a Timer1 count inside the millisecond. With a whole number
+ * of counts per us (1, 8, 12, 16 and 20 MHz) it is a 16-bit division by a
+ * constant, else the generic 32-bit one (count * 1000 fits in 32 bits) */
+#if ((TICK_COUNTS_PER_MS % 1000UL) == 0)
+#define CLOCK_COUNTS_TO_US(count)    ((count) / (uint16)(TICK_COUNTS_PER_MS / 1000UL))
+#else
+#define CLOCK_COUNTS_TO_US(count)    (((uint32)(count) * 1000UL) / TICK_COUNTS_PER_MS)
+#endif
+
+
+/*******************************************************************************
+ *                              Functions Definitions                          *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: CLOCK_millis
+ * Description  : Timestamp in milliseconds since TICK_init, safe to call
+ *                from an ISR
+ * INPUTS       : void
+ * RETURNS      : uint32 (milliseconds, wraps around after ~49 days)
+ **************************************************************************/
+uint32 CLOCK_millis(void)
+{
+	uint16 count;
+
+	/* not TICK_getMs, a millisecond whose interrupt is still pending counts */
+	return TICK_capture(&count);
+}
+
+
+/**************************************************************************
+ * Function Name: CLOCK_micros
+ * Description  : Timestamp in microseconds since TICK_init, to
+ *                CLOCK_RESOLUTION_US, safe to call from an ISR
+ * INPUTS       : void
+ * RETURNS      : uint32 (microseconds, wraps around after ~71 minutes)
+ **************************************************************************/
+uint32 CLOCK_micros(void)
+{
+	uint16 count;
+	uint32 ms = TICK_capture(&count);
+
+	/* wraps together with ms * 1000, so it stays monotonic modulo 2^32 */
+	return (ms * 1000UL) + CLOCK_COUNTS_TO_US(count);
+}
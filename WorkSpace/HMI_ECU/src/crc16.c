@@ -0,0 +1,61 @@
+/*===========================================================================================
+ * Filename   : crc16.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the CRC-16 (CCITT) calculation
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "crc16.h"
+
+
+/*******************************************************************************
+ *                              Functions Definitions                          *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: CRC16_update
+ * Description  : Add one byte to a running CRC, used when the data comes
+ *                one byte at a time (start with CRC16_INITIAL_VALUE)
+ * INPUTS       : crc (the running CRC), data (the new byte)
+ * RETURNS      : uint16 (the updated CRC)
+ **************************************************************************/
+uint16 CRC16_update(uint16 crc, uint8 data)
+{
+	uint8 i;
+
+	crc ^= ((uint16)data << 8);
+
+	/* bitwise division, no lookup table to keep the flash footprint small */
+	for(i = 0; i < 8; i++)
+	{
+		if(crc & 0x8000U)
+		{
+			crc = (uint16)((crc << 1) ^ CRC16_POLYNOMIAL);
+		}
+		else
+		{
+			crc = (uint16)(crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+
+/**************************************************************************
+ * Function Name: CRC16_compute
+ * Description  : Calculate the CRC of a whole buffer
+ * INPUTS       : data (buffer), len (number of bytes)
+ * RETURNS      : uint16 (CRC of the buffer)
+ **************************************************************************/
+uint16 CRC16_compute(const uint8 *data, uint16 len)
+{
+	uint16 crc = CRC16_INITIAL_VALUE;
+	uint16 i;
+
+	for(i = 0; i < len; i++)
+	{
+		crc = CRC16_update(crc, data[i]);
+	}
+
+	return crc;
+}
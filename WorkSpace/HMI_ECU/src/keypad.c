@@ -38,7 +38,7 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
 
 
 
-uint8 KEYPAD_getPressedKey(void)
+uint8 KEYPAD_scanKey(void)
 {
 	uint8 col,row;
 	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID, PIN_INPUT);
@@ -52,43 +52,56 @@ uint8 KEYPAD_getPressedKey(void)
 #if(KEYPAD_NUM_COLS == 4)
 	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+3, PIN_INPUT);
 #endif
-	while(1)
+
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
 	{
-		for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
-		{
-			/* 
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this row will be output pin
-			 */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
+		/* 
+		 * Each time setup the direction for all keypad port as input pins,
+		 * except this row will be output pin
+		 */
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
 
-			/* Set/Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
+		/* Set/Clear the row output pin */
+		GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
 
-			for(col=0 ; col<KEYPAD_NUM_COLS ; col++) /* loop for columns */
+		for(col=0 ; col<KEYPAD_NUM_COLS ; col++) /* loop for columns */
+		{
+			/* Check if the switch is pressed in this column */
+			if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
 			{
-				/* Check if the switch is pressed in this column */
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
-					#elif (KEYPAD_NUM_COLS == 4)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
+				#if (KEYPAD_NUM_COLS == 3)
+					#ifdef STANDARD_KEYPAD
+						return ((row*KEYPAD_NUM_COLS)+col+1);
+					#else
+						return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
+					#endif
+				#elif (KEYPAD_NUM_COLS == 4)
+					#ifdef STANDARD_KEYPAD
+						return ((row*KEYPAD_NUM_COLS)+col+1);
+					#else
+						return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
 					#endif
-				}
+				#endif
 			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
-			_delay_ms(5); /* Add small delay to fix CPU load issue in proteus */
 		}
-	}	
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
+	}
+
+	return KEYPAD_NO_KEY;
+}
+
+
+
+uint8 KEYPAD_getPressedKey(void)
+{
+	uint8 key;
+
+	while((key = KEYPAD_scanKey()) == KEYPAD_NO_KEY)
+	{
+		_delay_ms(5); /* Add small delay to fix CPU load issue in proteus */
+	}
+
+	return key;
 }
 
 #ifndef STANDARD_KEYPAD
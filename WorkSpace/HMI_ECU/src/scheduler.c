@@ -0,0 +1,136 @@
+/*===========================================================================================
+ * Filename   : scheduler.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the cooperative run-to-completion task scheduler
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "scheduler.h"
+#include "soft_timer.h"
+#include "gpio.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* queued tasks of each priority, the ISRs post to them too */
+static SCHEDULER_TaskType *volatile SCHEDULER_Head[SCHEDULER_PRIORITIES];
+static SCHEDULER_TaskType *volatile SCHEDULER_Tail[SCHEDULER_PRIORITIES];
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: SCHEDULER_post
+ * Description  : Queue a task to be run once, from the main loop or an ISR.
+ *                Posting a task that is still queued does nothing, so an
+ *                event that happens again before it is served costs nothing
+ *                (the task reads what is pending, e.g. a whole RX buffer)
+ * INPUTS       : task
+ * RETURNS      : void
+ **************************************************************************/
+void SCHEDULER_post(SCHEDULER_TaskType *task)
+{
+	uint8 sreg = SREG;
+
+	/* the main loop and the ISRs both link tasks */
+	SREG &= ~(1 << 7);
+
+	if(task->queued == FALSE)
+	{
+		task->queued = TRUE;
+		task->next = NULL_PTR;
+		if(SCHEDULER_Tail[task->priority] != NULL_PTR)
+		{
+			SCHEDULER_Tail[task->priority]->next = task;
+		}
+		else
+		{
+			SCHEDULER_Head[task->priority] = task;
+		}
+		SCHEDULER_Tail[task->priority] = task;
+	}
+
+	SREG = sreg;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SCHEDULER_take
+ * Description  : Unlink the first task of the highest priority queue, with
+ *                the interrupts already disabled
+ * INPUTS       : void
+ * RETURNS      : SCHEDULER_TaskType* (NULL_PTR if no task is queued)
+ **************************************************************************/
+static SCHEDULER_TaskType *SCHEDULER_take(void)
+{
+	SCHEDULER_TaskType *task;
+	uint8 priority;
+
+	for(priority = 0; priority < SCHEDULER_PRIORITIES; priority++)
+	{
+		task = SCHEDULER_Head[priority];
+		if(task != NULL_PTR)
+		{
+			SCHEDULER_Head[priority] = task->next;
+			if(task->next == NULL_PTR)
+			{
+				SCHEDULER_Tail[priority] = NULL_PTR;
+			}
+
+			/* it may be posted again while it runs, it will then run once more */
+			task->queued = FALSE;
+			return task;
+		}
+	}
+
+	return NULL_PTR;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SCHEDULER_run
+ * Description  : Event loop, never returns. Calls the callBacks of the
+ *                expired software timers, then runs the next queued task,
+ *                and puts the CPU in idle sleep when there is nothing to do
+ *                (any interrupt wakes it, the 1 ms tick at least)
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void SCHEDULER_run(void)
+{
+	SCHEDULER_TaskType *task;
+
+	/* idle sleep keeps the timers and the UART running */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	while(1)
+	{
+		/* the timers are checked between two tasks, so a timer is late by
+		 * one task at most */
+		SOFT_TIMER_process();
+
+		SREG &= ~(1 << 7);
+		task = SCHEDULER_take();
+		if(task != NULL_PTR)
+		{
+			SREG |= (1 << 7);
+			task->run();
+		}
+		else
+		{
+			/* the instruction after sei is always executed, so an interrupt
+			 * that posts a task after the check still wakes the CPU up */
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+	}
+}
@@ -0,0 +1,212 @@
+/*===========================================================================================
+ * Filename   : soft_timer.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the software timers, a timer wheel driven by the 1 ms tick
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "soft_timer.h"
+#include "tick.h"
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* started timers, linked in the slot of their expiry tick */
+static SOFT_TIMER_Type *SOFT_TIMER_Wheel[SOFT_TIMER_SLOTS];
+
+/* last tick processed, the wheel catches up with TICK_getMs one tick at a time */
+static uint32 SOFT_TIMER_Cursor = 0;
+
+/* started timers, the wheel jumps to the current tick when there is none */
+static uint8 SOFT_TIMER_Count = 0;
+
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_link
+ * Description  : Put a timer in the slot of its expiry
+ * INPUTS       : timer (expiry already set)
+ * RETURNS      : void
+ **************************************************************************/
+static void SOFT_TIMER_link(SOFT_TIMER_Type *timer)
+{
+	SOFT_TIMER_Type **head = &SOFT_TIMER_Wheel[timer->expiry & (SOFT_TIMER_SLOTS - 1)];
+
+	timer->prev = NULL_PTR;
+	timer->next = *head;
+	if(*head != NULL_PTR)
+	{
+		(*head)->prev = timer;
+	}
+	*head = timer;
+
+	timer->active = TRUE;
+	SOFT_TIMER_Count++;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_unlink
+ * Description  : Take a timer out of its slot
+ * INPUTS       : timer (active)
+ * RETURNS      : void
+ **************************************************************************/
+static void SOFT_TIMER_unlink(SOFT_TIMER_Type *timer)
+{
+	if(timer->prev != NULL_PTR)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		SOFT_TIMER_Wheel[timer->expiry & (SOFT_TIMER_SLOTS - 1)] = timer->next;
+	}
+
+	if(timer->next != NULL_PTR)
+	{
+		timer->next->prev = timer->prev;
+	}
+
+	timer->active = FALSE;
+	SOFT_TIMER_Count--;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_start
+ * Description  : Start (or restart) a timer, its callBack is called by
+ *                SOFT_TIMER_process after delay_ms, then every period_ms
+ *                if it is periodic. Not to be called from an ISR.
+ * INPUTS       : timer, delay_ms (at least 1), period_ms (0 for one-shot),
+ *                callBack
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_start(SOFT_TIMER_Type *timer, uint32 delay_ms, uint32 period_ms, void (*callBack)(void))
+{
+	if(timer->active == TRUE)
+	{
+		SOFT_TIMER_unlink(timer);
+	}
+
+	/* the wheel is up to date when there is no timer, or it is catching up
+	 * inside SOFT_TIMER_process: the delay counts from the current tick */
+	if(SOFT_TIMER_Count == 0)
+	{
+		SOFT_TIMER_Cursor = TICK_getMs();
+	}
+
+	/* the slot of the cursor has been processed already */
+	if(delay_ms == 0)
+	{
+		delay_ms = 1;
+	}
+
+	timer->expiry = TICK_getMs() + delay_ms;
+	timer->period = period_ms;
+	timer->callBack = callBack;
+	SOFT_TIMER_link(timer);
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_stop
+ * Description  : Stop a timer, nothing happens if it is not started
+ * INPUTS       : timer
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_stop(SOFT_TIMER_Type *timer)
+{
+	if(timer->active == TRUE)
+	{
+		SOFT_TIMER_unlink(timer);
+	}
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_isActive
+ * Description  : Tell if a timer is started and not expired yet (a periodic
+ *                timer stays active till it is stopped)
+ * INPUTS       : timer
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean SOFT_TIMER_isActive(const SOFT_TIMER_Type *timer)
+{
+	return timer->active;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_getRemaining
+ * Description  : Time left before the next expiry of a timer
+ * INPUTS       : timer
+ * RETURNS      : uint32 (milliseconds, 0 if it is stopped or already due)
+ **************************************************************************/
+uint32 SOFT_TIMER_getRemaining(const SOFT_TIMER_Type *timer)
+{
+	uint32 remaining = timer->expiry - TICK_getMs();
+
+	/* the wheel may not have caught up with an expiry that has passed */
+	if((timer->active == FALSE) || ((sint32)remaining <= 0))
+	{
+		return 0;
+	}
+
+	return remaining;
+}
+
+
+
+/**************************************************************************
+ * Function Name: SOFT_TIMER_process
+ * Description  : Move the wheel up to the current tick and call the
+ *                callBack of every expired timer, in the main loop context.
+ *                A callBack may start or stop any timer.
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void SOFT_TIMER_process(void)
+{
+	uint32 now = TICK_getMs();
+	SOFT_TIMER_Type *timer;
+
+	while((SOFT_TIMER_Cursor != now) && (SOFT_TIMER_Count != 0))
+	{
+		SOFT_TIMER_Cursor++;
+
+		/* the slot also holds timers of the next turns, only the ones of this
+		 * tick expire. The slot is searched again after every callBack since
+		 * it may have started or stopped timers */
+		do
+		{
+			timer = SOFT_TIMER_Wheel[SOFT_TIMER_Cursor & (SOFT_TIMER_SLOTS - 1)];
+			while((timer != NULL_PTR) && (timer->expiry != SOFT_TIMER_Cursor))
+			{
+				timer = timer->next;
+			}
+
+			if(timer != NULL_PTR)
+			{
+				SOFT_TIMER_unlink(timer);
+				if(timer->period != 0)
+				{
+					/* from the expiry, not from the tick it is processed at, so it never drifts */
+					timer->expiry += timer->period;
+					SOFT_TIMER_link(timer);
+				}
+				timer->callBack();
+			}
+		}while(timer != NULL_PTR);
+	}
+
+	SOFT_TIMER_Cursor = now;
+}
@@ -0,0 +1,116 @@
+/*===========================================================================================
+ * Filename   : tick.c
+ * Author     : Ahmad Haroun
+ * Description: Source file for the millisecond system tick (Timer1)
+ * Created on : SEP 4, 2023
+ *==========================================================================================*/
+#include "tick.h"
+#include "timer1.h"
+
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+
+/* milliseconds since TICK_init, incremented by TIMER1_COMPA_vect */
+volatile uint32 TICK_Counter = 0;
+
+
+/*******************************************************************************
+ *                              Functions Definitions                          *
+ *******************************************************************************/
+
+/**************************************************************************
+ * Function Name: TICK_init
+ * Description  : Start Timer1 as a free running 1 ms tick, it is started
+ *                once and shared by all the delays and timeouts
+ * INPUTS       : void
+ * RETURNS      : void
+ **************************************************************************/
+void TICK_init(void)
+{
+	Timer1_ConfigType config = {0, TICK_COMPARE_VALUE, TICK_PRESCALER_ID, Timer1_CTC_Mode};
+
+	TICK_Counter = 0;
+
+	Timer1_init(&config);
+}
+
+
+/**************************************************************************
+ * Function Name: TICK_getMs
+ * Description  : Get the number of milliseconds since TICK_init
+ * INPUTS       : void
+ * RETURNS      : uint32 (milliseconds, wraps around after ~49 days)
+ **************************************************************************/
+uint32 TICK_getMs(void)
+{
+	uint32 ms;
+	uint8 sreg = SREG;
+
+	/* 32-bit read is not atomic on an 8-bit CPU, block the tick interrupt meanwhile */
+	SREG &= ~(1 << 7);
+	ms = TICK_Counter;
+	SREG = sreg;
+
+	return ms;
+}
+
+
+/**************************************************************************
+ * Function Name: TICK_capture
+ * Description  : Get the milliseconds since TICK_init together with the
+ *                Timer1 count inside the current millisecond, both read
+ *                in the same critical section (also from an ISR)
+ * INPUTS       : count (0 .. TICK_COMPARE_VALUE)
+ * RETURNS      : uint32 (milliseconds)
+ **************************************************************************/
+uint32 TICK_capture(uint16 *count)
+{
+	uint32 ms;
+	uint8 sreg = SREG;
+
+	SREG &= ~(1 << 7);
+	ms = TICK_Counter;
+	*count = TCNT1;
+
+	/* the count wrapped to 0 but TICK_onCompare did not run yet (interrupts
+	 * are blocked here, or this is called from another ISR), so
+	 * that millisecond is not in TICK_Counter. The count is read again as
+	 * the first read may have been just before the wrap */
+	if(TIFR & (1 << OCF1A))
+	{
+		ms++;
+		*count = TCNT1;
+	}
+	SREG = sreg;
+
+	return ms;
+}
+
+
+/**************************************************************************
+ * Function Name: TICK_isExpired
+ * Description  : Check if a deadline (TICK_getMs() + timeout) has passed,
+ *                works across the counter wrap around
+ * INPUTS       : deadline (in milliseconds)
+ * RETURNS      : boolean
+ **************************************************************************/
+boolean TICK_isExpired(uint32 deadline)
+{
+	return ((sint32)(TICK_getMs() - deadline) >= 0);
+}
+
+
+/**************************************************************************
+ * Function Name: TICK_delayMs
+ * Description  : Wait for a number of milliseconds using the shared tick
+ * INPUTS       : ms (time to wait)
+ * RETURNS      : void
+ **************************************************************************/
+void TICK_delayMs(uint32 ms)
+{
+	uint32 deadline = TICK_getMs() + ms;
+
+	while(TICK_isExpired(deadline) == FALSE){}
+}